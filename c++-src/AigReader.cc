@@ -0,0 +1,299 @@
+﻿
+/// @file AigReader.cc
+/// @brief AigReader の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "AigReader.h"
+#include "FraigMgrImpl.h"
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+BEGIN_NAMESPACE_FRAIG
+
+//////////////////////////////////////////////////////////////////////
+// クラス AigReader
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+AigReader::AigReader() :
+  mData(nullptr),
+  mSize(0),
+  mCur(nullptr),
+  mEnd(nullptr),
+  mMaxVar(0),
+  mInputNum(0),
+  mLatchNum(0),
+  mOutputNum(0),
+  mAndNum(0),
+  mBadNum(0)
+{
+}
+
+// @brief デストラクタ
+AigReader::~AigReader()
+{
+  close();
+}
+
+// @brief ファイルを開いてヘッダを読み込む．
+// @param[in] filename ファイル名
+// @return 成功したら true を返す．
+bool
+AigReader::open(const string& filename)
+{
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if ( fd < 0 ) {
+    return false;
+  }
+  struct stat sb;
+  if ( fstat(fd, &sb) < 0 || sb.st_size == 0 ) {
+    ::close(fd);
+    return false;
+  }
+  void* addr = mmap(nullptr, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // マップした後はファイル記述子は不要
+  ::close(fd);
+  if ( addr == MAP_FAILED ) {
+    return false;
+  }
+  // 先頭から順に一度だけ読む．
+  madvise(addr, sb.st_size, MADV_SEQUENTIAL);
+
+  mData = static_cast<const char*>(addr);
+  mSize = sb.st_size;
+  mCur = mData;
+  mEnd = mData + mSize;
+
+  // ヘッダは "aig M I L O A [B [C [J [F]]]]"
+  if ( !read_char('a') || !read_char('i') || !read_char('g') ) {
+    return false;
+  }
+  SizeType num[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  int n = 0;
+  while ( n < 9 && read_char(' ') ) {
+    if ( !read_number(num[n]) ) {
+      return false;
+    }
+    ++ n;
+  }
+  if ( n < 5 || !read_char('\n') ) {
+    return false;
+  }
+  // invariant constraint，justice，fairness は扱わない．
+  if ( num[6] > 0 || num[7] > 0 || num[8] > 0 ) {
+    return false;
+  }
+  // 入力数と出力数は int に収まらなければならない．
+  const SizeType kMaxNum = std::numeric_limits<int>::max();
+  if ( num[1] > kMaxNum || num[2] > kMaxNum ||
+       num[3] > kMaxNum || num[5] > kMaxNum ||
+       num[1] + num[2] > kMaxNum ||
+       num[3] + num[2] + num[5] > kMaxNum ) {
+    return false;
+  }
+  // AND ゲートは少なくとも2バイトを使うので
+  // ファイルの大きさを超える数は壊れている．
+  if ( num[4] > mSize / 2 ) {
+    return false;
+  }
+  // バイナリ形式では変数番号に欠番はない．
+  if ( num[0] != num[1] + num[2] + num[4] ) {
+    return false;
+  }
+  mMaxVar = num[0];
+  mInputNum = num[1];
+  mLatchNum = num[2];
+  mOutputNum = num[3];
+  mAndNum = num[4];
+  mBadNum = num[5];
+
+  return true;
+}
+
+// @brief 本体を読み込んでノードを作る．
+// @param[in] mgr ノードを作るオブジェクト
+// @param[in] input_handles 入力に接続するハンドルのリスト
+// @param[out] output_handles 出力に対応したハンドルのリスト
+// @return 成功したら true を返す．
+bool
+AigReader::read(FraigMgrImpl& mgr,
+		const vector<FraigHandle>& input_handles,
+		vector<FraigHandle>& output_handles)
+{
+  ASSERT_COND( mData != nullptr );
+  ASSERT_COND( input_handles.size() == static_cast<SizeType>(input_num()) );
+
+  output_handles.clear();
+
+  // 変数番号をキーにしてハンドルを持つ表
+  // 入力の変数番号は 1 から input_num() まで順に割り当てられている．
+  vector<FraigHandle> var_map(mMaxVar + 1);
+  var_map[0] = FraigHandle::zero();
+  for ( int i = 0; i < input_num(); ++ i ) {
+    var_map[i + 1] = input_handles[i];
+  }
+  auto lit_handle = [&](SizeType lit) {
+    FraigHandle h = var_map[lit >> 1];
+    return (lit & 1) ? ~h : h;
+  };
+
+  // 1. ラッチ，出力，bad state の行を読む．
+  //    AND ゲートを参照するのでリテラルのまま覚えておく．
+  //    ラッチの行は初期値が続くことがある．
+  vector<SizeType> latch_lits(mLatchNum);
+  for ( int i = 0; i < mLatchNum; ++ i ) {
+    if ( !read_line(latch_lits[i], 1) ) {
+      return false;
+    }
+  }
+  vector<SizeType> output_lits;
+  output_lits.reserve(output_num());
+  for ( int i = 0; i < mOutputNum; ++ i ) {
+    SizeType lit;
+    if ( !read_line(lit, 0) ) {
+      return false;
+    }
+    output_lits.push_back(lit);
+  }
+  output_lits.insert(output_lits.end(), latch_lits.begin(), latch_lits.end());
+  for ( int i = 0; i < mBadNum; ++ i ) {
+    SizeType lit;
+    if ( !read_line(lit, 0) ) {
+      return false;
+    }
+    output_lits.push_back(lit);
+  }
+  for ( auto lit: output_lits ) {
+    if ( (lit >> 1) > mMaxVar ) {
+      return false;
+    }
+  }
+
+  // 2. AND ゲートを読む．
+  //    左辺は入力の次から順に割り当てられているので書かれていない．
+  //    右辺は lhs > rhs0 >= rhs1 で，差分が可変長で書かれている．
+  SizeType lhs = static_cast<SizeType>(input_num() + 1) * 2;
+  for ( SizeType i = 0; i < mAndNum; ++ i, lhs += 2 ) {
+    SizeType delta0;
+    SizeType delta1;
+    if ( !read_delta(delta0) || !read_delta(delta1) ) {
+      return false;
+    }
+    if ( delta0 == 0 || delta0 > lhs ) {
+      return false;
+    }
+    SizeType rhs0 = lhs - delta0;
+    if ( delta1 > rhs0 ) {
+      return false;
+    }
+    SizeType rhs1 = rhs0 - delta1;
+    var_map[lhs >> 1] = mgr.make_and(lit_handle(rhs0), lit_handle(rhs1));
+  }
+  // この後のシンボルテーブルやコメントは読まない．
+
+  output_handles.reserve(output_lits.size());
+  for ( auto lit: output_lits ) {
+    output_handles.push_back(lit_handle(lit));
+  }
+
+  return true;
+}
+
+// @brief マップしたファイルを解放する．
+void
+AigReader::close()
+{
+  if ( mData != nullptr ) {
+    munmap(const_cast<char*>(mData), mSize);
+    mData = nullptr;
+    mSize = 0;
+    mCur = nullptr;
+    mEnd = nullptr;
+  }
+}
+
+// @brief 10進数を読み込む．
+// @param[out] val 読み込んだ値
+// @return 数字で始まっていなければ false を返す．
+bool
+AigReader::read_number(SizeType& val)
+{
+  if ( mCur == mEnd || *mCur < '0' || *mCur > '9' ) {
+    return false;
+  }
+  val = 0;
+  for ( ; mCur != mEnd && *mCur >= '0' && *mCur <= '9'; ++ mCur ) {
+    SizeType d = *mCur - '0';
+    if ( val > (std::numeric_limits<SizeType>::max() - d) / 10 ) {
+      return false;
+    }
+    val = val * 10 + d;
+  }
+  return true;
+}
+
+// @brief 1文字読み込む．
+// @param[in] c 期待する文字
+// @return 次の文字が c でなければ false を返す．
+bool
+AigReader::read_char(char c)
+{
+  if ( mCur == mEnd || *mCur != c ) {
+    return false;
+  }
+  ++ mCur;
+  return true;
+}
+
+// @brief ラッチ，出力などの1行を読み込む．
+// @param[out] lit リテラル
+// @param[in] opt_num 後に続いてもよい数の個数
+bool
+AigReader::read_line(SizeType& lit,
+		     int opt_num)
+{
+  if ( !read_number(lit) ) {
+    return false;
+  }
+  for ( int i = 0; i < opt_num && read_char(' '); ++ i ) {
+    SizeType dummy;
+    if ( !read_number(dummy) ) {
+      return false;
+    }
+  }
+  return read_char('\n');
+}
+
+// @brief 差分符号化された数を読み込む．
+// @param[out] val 読み込んだ値
+//
+// 下位から7ビットずつ，続きがあるバイトは最上位ビットを立てて書かれている．
+bool
+AigReader::read_delta(SizeType& val)
+{
+  val = 0;
+  for ( int shift = 0; shift < 64; shift += 7 ) {
+    if ( mCur == mEnd ) {
+      return false;
+    }
+    ymuint8 c = static_cast<ymuint8>(*mCur);
+    ++ mCur;
+    val |= static_cast<SizeType>(c & 0x7F) << shift;
+    if ( (c & 0x80) == 0 ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+END_NAMESPACE_FRAIG
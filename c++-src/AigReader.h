@@ -0,0 +1,187 @@
+﻿#ifndef AIGREADER_H
+#define AIGREADER_H
+
+/// @file AigReader.h
+/// @brief AigReader のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "ym/fraig.h"
+#include "ym/FraigHandle.h"
+
+
+BEGIN_NAMESPACE_FRAIG
+
+class FraigMgrImpl;
+
+//////////////////////////////////////////////////////////////////////
+/// @class AigReader AigReader.h "AigReader.h"
+/// @brief バイナリ AIGER 形式のファイルを読み込むクラス
+///
+/// ファイルはメモリにマップし，中間のデータ構造を作らずに
+/// 差分符号化された AND ゲートを順に FraigMgrImpl::make_and() に渡す．
+/// ラッチは組み合わせ回路として扱い，ラッチの出力を擬似入力，
+/// ラッチの入力を擬似出力とする．
+/// AIGER 1.9 の bad state は出力として扱い，
+/// invariant constraint，justice，fairness を含むファイルは読み込まない．
+//////////////////////////////////////////////////////////////////////
+class AigReader
+{
+public:
+
+  /// @brief コンストラクタ
+  AigReader();
+
+  /// @brief デストラクタ
+  ~AigReader();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief ファイルを開いてヘッダを読み込む．
+  /// @param[in] filename ファイル名
+  /// @return 成功したら true を返す．
+  bool
+  open(const string& filename);
+
+  /// @brief 入力数を返す．
+  ///
+  /// 外部入力，ラッチの出力の順に並ぶ．
+  int
+  input_num() const;
+
+  /// @brief 出力数を返す．
+  ///
+  /// 外部出力，ラッチの入力，bad state の順に並ぶ．
+  int
+  output_num() const;
+
+  /// @brief AND ゲート数を返す．
+  SizeType
+  and_num() const;
+
+  /// @brief 本体を読み込んでノードを作る．
+  /// @param[in] mgr ノードを作るオブジェクト
+  /// @param[in] input_handles 入力に接続するハンドルのリスト
+  /// @param[out] output_handles 出力に対応したハンドルのリスト
+  /// @return 成功したら true を返す．
+  ///
+  /// input_handles の大きさは input_num() と等しくなければならない．
+  /// 途中で失敗した場合もそれまでに作ったノードは残る．
+  bool
+  read(FraigMgrImpl& mgr,
+       const vector<FraigHandle>& input_handles,
+       vector<FraigHandle>& output_handles);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief マップしたファイルを解放する．
+  void
+  close();
+
+  /// @brief 10進数を読み込む．
+  /// @param[out] val 読み込んだ値
+  /// @return 数字で始まっていなければ false を返す．
+  bool
+  read_number(SizeType& val);
+
+  /// @brief 1文字読み込む．
+  /// @param[in] c 期待する文字
+  /// @return 次の文字が c でなければ false を返す．
+  bool
+  read_char(char c);
+
+  /// @brief ラッチ，出力などの1行を読み込む．
+  /// @param[out] lit リテラル
+  /// @param[in] opt_num 後に続いてもよい数の個数
+  ///
+  /// 後に続く数(ラッチの初期値)は読み飛ばす．
+  bool
+  read_line(SizeType& lit,
+	    int opt_num);
+
+  /// @brief 差分符号化された数を読み込む．
+  /// @param[out] val 読み込んだ値
+  bool
+  read_delta(SizeType& val);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // マップしたファイルの先頭
+  const char* mData;
+
+  // マップしたファイルの大きさ
+  SizeType mSize;
+
+  // 読み込み位置
+  const char* mCur;
+
+  // ファイルの末尾
+  const char* mEnd;
+
+  // 最大の変数番号
+  SizeType mMaxVar;
+
+  // 外部入力数
+  int mInputNum;
+
+  // ラッチ数
+  int mLatchNum;
+
+  // 外部出力数
+  int mOutputNum;
+
+  // AND ゲート数
+  SizeType mAndNum;
+
+  // bad state 数
+  int mBadNum;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief 入力数を返す．
+inline
+int
+AigReader::input_num() const
+{
+  return mInputNum + mLatchNum;
+}
+
+// @brief 出力数を返す．
+inline
+int
+AigReader::output_num() const
+{
+  return mOutputNum + mLatchNum + mBadNum;
+}
+
+// @brief AND ゲート数を返す．
+inline
+SizeType
+AigReader::and_num() const
+{
+  return mAndNum;
+}
+
+END_NAMESPACE_FRAIG
+
+#endif // AIGREADER_H
@@ -0,0 +1,164 @@
+﻿
+/// @file AigWriter.cc
+/// @brief AigWriter の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "AigWriter.h"
+#include "FraigMgrImpl.h"
+#include "FraigNode.h"
+#include <unordered_map>
+
+
+BEGIN_NAMESPACE_FRAIG
+
+BEGIN_NONAMESPACE
+
+// 変数番号が割り当てられていないことを表す値
+const SizeType kNoLit = static_cast<SizeType>(-1);
+
+END_NONAMESPACE
+
+//////////////////////////////////////////////////////////////////////
+// クラス AigWriter
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+// @param[in] mgr ノードを持つオブジェクト
+// @param[in] output_handles 出力のハンドルのリスト
+AigWriter::AigWriter(const FraigMgrImpl& mgr,
+		     const vector<FraigHandle>& output_handles) :
+  mInputNum(mgr.input_num())
+{
+  // ノード番号をキーにしてリテラルを持つ表
+  vector<SizeType> lit_map(mgr.node_num(), kNoLit);
+  for ( int i = 0; i < mInputNum; ++ i ) {
+    lit_map[mgr.input_node(i)->id()] = static_cast<SizeType>(i + 1) * 2;
+  }
+
+  // ハンドルを代表ノードのリテラルに変換する．
+  // 代表ノードにリテラルが割り当てられていない時は kNoLit を返す．
+  auto handle_lit = [&](FraigHandle handle) {
+    handle = mgr.resolve_rep(handle);
+    if ( handle.is_const() ) {
+      return static_cast<SizeType>(handle.is_one() ? 1 : 0);
+    }
+    SizeType lit = lit_map[handle.node_id()];
+    if ( lit == kNoLit ) {
+      return kNoLit;
+    }
+    return handle.inv() ? lit ^ 1 : lit;
+  };
+
+  // ファンインのリテラルの対をキーにして AND のリテラルを持つ表
+  std::unordered_map<ymuint64, SizeType> and_hash;
+
+  // 出力から深さ優先でたどり，帰りがけに番号をつける．
+  // 深い回路でもスタックが溢れないように明示的なスタックを用いる．
+  vector<int> id_stack;
+  for ( auto handle: output_handles ) {
+    FraigHandle rep = mgr.resolve_rep(handle);
+    if ( !rep.is_const() && lit_map[rep.node_id()] == kNoLit ) {
+      id_stack.push_back(rep.node_id());
+    }
+    while ( !id_stack.empty() ) {
+      int id = id_stack.back();
+      if ( lit_map[id] != kNoLit ) {
+	// 他のファンアウトから先に処理された．
+	id_stack.pop_back();
+	continue;
+      }
+      FraigNode* node = mgr.node(id);
+      ASSERT_COND( node->is_and() );
+
+      FraigHandle handle0 = mgr.fanin_handle(node, 0);
+      FraigHandle handle1 = mgr.fanin_handle(node, 1);
+      SizeType lit0 = handle_lit(handle0);
+      SizeType lit1 = handle_lit(handle1);
+      if ( lit0 == kNoLit || lit1 == kNoLit ) {
+	if ( lit0 == kNoLit ) {
+	  id_stack.push_back(mgr.resolve_rep(handle0).node_id());
+	}
+	if ( lit1 == kNoLit ) {
+	  id_stack.push_back(mgr.resolve_rep(handle1).node_id());
+	}
+	continue;
+      }
+      id_stack.pop_back();
+
+      if ( lit0 < lit1 ) {
+	std::swap(lit0, lit1);
+      }
+      SizeType lit;
+      if ( lit1 == 0 || lit0 == (lit1 ^ 1) ) {
+	lit = 0;
+      }
+      else if ( lit1 == 1 || lit0 == lit1 ) {
+	lit = lit0;
+      }
+      else {
+	ymuint64 key = (static_cast<ymuint64>(lit0) << 32) | lit1;
+	auto p = and_hash.find(key);
+	if ( p != and_hash.end() ) {
+	  lit = p->second;
+	}
+	else {
+	  lit = static_cast<SizeType>(mInputNum + and_num() + 1) * 2;
+	  mFaninLits.push_back(lit0);
+	  mFaninLits.push_back(lit1);
+	  and_hash.emplace(key, lit);
+	}
+      }
+      lit_map[id] = lit;
+    }
+    mOutputLits.push_back(handle_lit(handle));
+  }
+}
+
+// @brief デストラクタ
+AigWriter::~AigWriter()
+{
+}
+
+// @brief バイナリ AIGER 形式で書き出す．
+// @param[in] s 出力先のストリーム
+void
+AigWriter::write_aig(ostream& s) const
+{
+  SizeType na = and_num();
+  s << "aig " << (mInputNum + na) << " " << mInputNum
+    << " 0 " << output_num() << " " << na << "\n";
+  for ( auto lit: mOutputLits ) {
+    s << lit << "\n";
+  }
+
+  // 差分は下位から7ビットずつ，続きがあるバイトは最上位ビットを立てて書く．
+  // 書き込みはバッファにまとめて行う．
+  const SizeType kBufSize = 1 << 16;
+  vector<char> buf;
+  buf.reserve(kBufSize + 32);
+  auto encode = [&](SizeType val) {
+    while ( val >= 0x80 ) {
+      buf.push_back(static_cast<char>((val & 0x7F) | 0x80));
+      val >>= 7;
+    }
+    buf.push_back(static_cast<char>(val));
+  };
+  SizeType lhs = static_cast<SizeType>(mInputNum + 1) * 2;
+  for ( SizeType i = 0; i < na; ++ i, lhs += 2 ) {
+    SizeType rhs0 = mFaninLits[i * 2 + 0];
+    SizeType rhs1 = mFaninLits[i * 2 + 1];
+    encode(lhs - rhs0);
+    encode(rhs0 - rhs1);
+    if ( buf.size() >= kBufSize ) {
+      s.write(buf.data(), buf.size());
+      buf.clear();
+    }
+  }
+  s.write(buf.data(), buf.size());
+}
+
+END_NAMESPACE_FRAIG
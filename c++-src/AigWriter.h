@@ -0,0 +1,155 @@
+﻿#ifndef AIGWRITER_H
+#define AIGWRITER_H
+
+/// @file AigWriter.h
+/// @brief AigWriter のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "ym/fraig.h"
+#include "ym/FraigHandle.h"
+
+
+BEGIN_NAMESPACE_FRAIG
+
+class FraigMgrImpl;
+
+//////////////////////////////////////////////////////////////////////
+/// @class AigWriter AigWriter.h "AigWriter.h"
+/// @brief 出力のファンインコーンの代表ノードを書き出すクラス
+///
+/// 出力から代表ノードのみをたどり，帰りがけ順に AIGER の変数番号を
+/// つけるので，ファンインは常に自分より小さい番号になる．
+/// 変数番号は AIGER と同じく入力が 1 から input_num() で，AND が続く．
+/// 入力は使われていないものも含めて全て入力番号の順に並ぶ．
+/// 代表ノードに置き換えた結果，ファンインが定数や同じリテラルになった AND や
+/// 同じファンインをもつ AND は作らない．
+//////////////////////////////////////////////////////////////////////
+class AigWriter
+{
+public:
+
+  /// @brief コンストラクタ
+  /// @param[in] mgr ノードを持つオブジェクト
+  /// @param[in] output_handles 出力のハンドルのリスト
+  AigWriter(const FraigMgrImpl& mgr,
+	    const vector<FraigHandle>& output_handles);
+
+  /// @brief デストラクタ
+  ~AigWriter();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 入力数を返す．
+  int
+  input_num() const;
+
+  /// @brief 出力数を返す．
+  int
+  output_num() const;
+
+  /// @brief AND 数を返す．
+  SizeType
+  and_num() const;
+
+  /// @brief AND のファンインのリテラルを返す．
+  /// @param[in] pos AND の番号 ( 0 <= pos < and_num() )
+  /// @param[in] fpos ファンインの位置 ( 0 or 1 )
+  ///
+  /// AND の変数番号は input_num() + pos + 1 で，
+  /// 0 番めのファンインの方が大きいリテラルになる．
+  SizeType
+  and_fanin_lit(SizeType pos,
+		int fpos) const;
+
+  /// @brief 出力のリテラルを返す．
+  /// @param[in] pos 出力番号 ( 0 <= pos < output_num() )
+  SizeType
+  output_lit(int pos) const;
+
+  /// @brief バイナリ AIGER 形式で書き出す．
+  /// @param[in] s 出力先のストリーム
+  void
+  write_aig(ostream& s) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // 入力数
+  int mInputNum;
+
+  // AND のファンインのリテラルを2つずつ並べたもの
+  vector<SizeType> mFaninLits;
+
+  // 出力のリテラルのリスト
+  vector<SizeType> mOutputLits;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief 入力数を返す．
+inline
+int
+AigWriter::input_num() const
+{
+  return mInputNum;
+}
+
+// @brief 出力数を返す．
+inline
+int
+AigWriter::output_num() const
+{
+  return mOutputLits.size();
+}
+
+// @brief AND 数を返す．
+inline
+SizeType
+AigWriter::and_num() const
+{
+  return mFaninLits.size() / 2;
+}
+
+// @brief AND のファンインのリテラルを返す．
+// @param[in] pos AND の番号 ( 0 <= pos < and_num() )
+// @param[in] fpos ファンインの位置 ( 0 or 1 )
+inline
+SizeType
+AigWriter::and_fanin_lit(SizeType pos,
+			 int fpos) const
+{
+  ASSERT_COND( pos < and_num() );
+  ASSERT_COND( fpos == 0 || fpos == 1 );
+
+  return mFaninLits[pos * 2 + fpos];
+}
+
+// @brief 出力のリテラルを返す．
+// @param[in] pos 出力番号 ( 0 <= pos < output_num() )
+inline
+SizeType
+AigWriter::output_lit(int pos) const
+{
+  ASSERT_COND( pos >= 0 && pos < output_num() );
+
+  return mOutputLits[pos];
+}
+
+END_NAMESPACE_FRAIG
+
+#endif // AIGWRITER_H
@@ -0,0 +1,369 @@
+﻿
+/// @file EqClassMgr.cc
+/// @brief EqClassMgr の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "EqClassMgr.h"
+#include "FraigNode.h"
+#include "FraigMgrImpl.h"
+
+
+BEGIN_NAMESPACE_FRAIG
+
+//////////////////////////////////////////////////////////////////////
+// EqClassMgr
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+EqClassMgr::EqClassMgr() :
+  mIndex(1024, -1)
+{
+}
+
+// @brief デストラクタ
+EqClassMgr::~EqClassMgr()
+{
+}
+
+// @brief 論理的に等価なノードを探す．
+// @param[in] node 対象のノード
+// @param[in] mgr FraigMgr
+// @param[out] ans 答のハンドル
+// @retval true ノードが見つかった．
+// @retval false ノードが見つからなかった．
+//
+// 見つからなかった場合には node をパタンの等しいクラスに追加する．
+bool
+EqClassMgr::find(FraigNode* node,
+		 FraigMgrImpl& mgr,
+		 FraigHandle& ans)
+{
+  bool inv0 = node->pat_hash_inv();
+  for ( ; ; ) {
+    // 確定したパタンが等しいクラスを探す．
+    SizeType key;
+    int key_end;
+    int cid = search(node, mgr, key, key_end);
+    if ( cid == -1 ) {
+      // 新しいクラスを作る．
+      add_class(node, mgr, key, key_end);
+      return false;
+    }
+
+    // クラスの要素を順に調べる．
+    bool retry = false;
+    for ( int id1 = mClassArray[cid].mTop->id();
+	  id1 != -1; id1 = next_id(id1) ) {
+      FraigNode* node1 = mgr.node(id1);
+      bool inv = node1->pat_hash_inv() ^ inv0;
+      if ( mgr.compare_node(node1, node, inv, retry) ) {
+	ans = FraigHandle(node1->id(), inv);
+	return true;
+      }
+      if ( retry ) {
+	// クラスが分割されたのでやり直す．
+	break;
+      }
+    }
+    if ( !retry ) {
+      add_node(cid, node);
+      if ( mClassArray[cid].mNum == 2 ) {
+	mNonTrivialList.push_back(cid);
+      }
+      return false;
+    }
+  }
+}
+
+// @brief パタンの等しいクラスにノードを加える．
+// @param[in] node 対象のノード
+// @param[in] mgr FraigMgr
+void
+EqClassMgr::add(FraigNode* node,
+		FraigMgrImpl& mgr)
+{
+  SizeType key;
+  int key_end;
+  int cid = search(node, mgr, key, key_end);
+  if ( cid == -1 ) {
+    add_class(node, mgr, key, key_end);
+    return;
+  }
+  add_node(cid, node);
+  if ( mClassArray[cid].mNum == 2 ) {
+    mNonTrivialList.push_back(cid);
+  }
+}
+
+// @brief 内容を空にする．
+void
+EqClassMgr::clear()
+{
+  mClassArray.clear();
+  for ( auto& cid: mIndex ) {
+    cid = -1;
+  }
+  mNonTrivialList.clear();
+  mLinkArray.clear();
+  mSplitMap.clear();
+}
+
+// @brief 追加されたワードでクラスを分割する．
+// @param[in] mgr FraigMgr
+// @param[in] start 開始位置
+// @param[in] end 終了位置
+//
+// 要素数が2以上のクラスのみを対象とする．
+void
+EqClassMgr::refine(FraigMgrImpl& mgr,
+		   int start,
+		   int end)
+{
+  vector<int> new_list;
+  new_list.reserve(mNonTrivialList.size());
+  vector<int> sub_list;
+  for ( int cid: mNonTrivialList ) {
+    int id = mClassArray[cid].mTop->id();
+    SizeType key = mClassArray[cid].mKey;
+    int key_end = mClassArray[cid].mKeyEnd;
+
+    // 各要素を分割後のクラスに振り分ける．
+    // 最初の部分クラスは元のクラス番号を引き継ぐ．
+    sub_list.clear();
+    int next = -1;
+    for ( ; id != -1; id = next ) {
+      next = next_id(id);
+      set_link(id, -1);
+      FraigNode* node = mgr.node(id);
+      int cid1 = -1;
+      for ( int cid2: sub_list ) {
+	FraigNode* top = mClassArray[cid2].mTop;
+	bool inv = top->pat_hash_inv() ^ node->pat_hash_inv();
+	if ( mgr.compare_pat(top, node, inv, start, end) ) {
+	  cid1 = cid2;
+	  break;
+	}
+      }
+      if ( cid1 != -1 ) {
+	add_node(cid1, node);
+      }
+      else if ( sub_list.empty() ) {
+	ClassInfo& info = mClassArray[cid];
+	info.mTop = node;
+	info.mTail = node;
+	info.mNum = 1;
+	sub_list.push_back(cid);
+      }
+      else {
+	sub_list.push_back(new_class(node, key, key_end));
+      }
+    }
+
+    // 分割されたら部分クラスを別々のキーに付け替える．
+    if ( sub_list.size() >= 2 ) {
+      split(mgr, key, key_end, end);
+    }
+
+    for ( int cid2: sub_list ) {
+      if ( mClassArray[cid2].mNum >= 2 ) {
+	new_list.push_back(cid2);
+      }
+    }
+  }
+  mNonTrivialList.swap(new_list);
+}
+
+// @brief パタンの等しいクラスを探す．
+// @param[in] node 対象のノード
+// @param[in] mgr FraigMgr
+// @param[out] key 最後に調べたキー
+// @param[out] key_end key の計算に用いたワード数
+// @return クラス番号を返す．
+//
+// 見つからなかった場合は -1 を返す．
+int
+EqClassMgr::search(FraigNode* node,
+		   FraigMgrImpl& mgr,
+		   SizeType& key,
+		   int& key_end)
+{
+  key_end = mgr.class_key_size();
+  key = mgr.class_key(node, 0ULL, 0, key_end);
+  bool inv0 = node->pat_hash_inv();
+  for ( ; ; ) {
+    SizeType pos = key & (mIndex.size() - 1);
+    for ( int cid = mIndex[pos]; cid != -1; cid = mClassArray[cid].mLink ) {
+      const ClassInfo& info = mClassArray[cid];
+      if ( info.mKey != key ) {
+	continue;
+      }
+      bool inv = info.mTop->pat_hash_inv() ^ inv0;
+      if ( mgr.compare_pat(info.mTop, node, inv, 0, mgr.pat_used()) ) {
+	return cid;
+      }
+    }
+
+    // このキーが分割されていたらキーを延ばして探し直す．
+    auto p = mSplitMap.find(key);
+    if ( p == mSplitMap.end() || p->second.mStart != key_end ) {
+      return -1;
+    }
+    key = mgr.class_key(node, key, key_end, p->second.mEnd);
+    key_end = p->second.mEnd;
+  }
+}
+
+// @brief search() で見つからなかったノードのクラスを作る．
+// @param[in] node 先頭のノード
+// @param[in] mgr FraigMgr
+// @param[in] key search() で最後に調べたキー
+// @param[in] key_end key の計算に用いたワード数
+// @return クラス番号を返す．
+//
+// 同じキーのクラスが既にある場合はキーを分割してから作る．
+int
+EqClassMgr::add_class(FraigNode* node,
+		      FraigMgrImpl& mgr,
+		      SizeType key,
+		      int key_end)
+{
+  int end = mgr.pat_used();
+  if ( key_end < end ) {
+    bool found = false;
+    SizeType pos = key & (mIndex.size() - 1);
+    for ( int cid = mIndex[pos]; cid != -1; cid = mClassArray[cid].mLink ) {
+      const ClassInfo& info = mClassArray[cid];
+      if ( info.mKey == key && info.mKeyEnd == key_end ) {
+	found = true;
+	break;
+      }
+    }
+    if ( found && split(mgr, key, key_end, end) ) {
+      key = mgr.class_key(node, key, key_end, end);
+      key_end = end;
+    }
+  }
+  return new_class(node, key, key_end);
+}
+
+// @brief キーの等しいクラスを長いパタンから計算したキーに付け替える．
+// @param[in] mgr FraigMgr
+// @param[in] key 分割するキー
+// @param[in] start key の計算に用いたワード数
+// @param[in] end 付け替えるキーの計算に用いるワード数
+// @return 付け替えた時 true を返す．
+//
+// 別の範囲で分割されたキーと衝突した時は付け替えない．
+bool
+EqClassMgr::split(FraigMgrImpl& mgr,
+		  SizeType key,
+		  int start,
+		  int end)
+{
+  if ( mSplitMap.count(key) > 0 ) {
+    return false;
+  }
+  mSplitMap.emplace(key, SplitInfo{start, end});
+
+  vector<int> cid_list;
+  SizeType pos = key & (mIndex.size() - 1);
+  for ( int cid = mIndex[pos]; cid != -1; cid = mClassArray[cid].mLink ) {
+    const ClassInfo& info = mClassArray[cid];
+    if ( info.mKey == key && info.mKeyEnd == start ) {
+      cid_list.push_back(cid);
+    }
+  }
+  for ( int cid: cid_list ) {
+    FraigNode* top = mClassArray[cid].mTop;
+    rekey(cid, mgr.class_key(top, key, start, end), end);
+  }
+  return true;
+}
+
+// @brief クラスのキーを付け替える．
+// @param[in] cid クラス番号
+// @param[in] key 新しいキー
+// @param[in] key_end key の計算に用いたワード数
+void
+EqClassMgr::rekey(int cid,
+		  SizeType key,
+		  int key_end)
+{
+  ClassInfo& info = mClassArray[cid];
+
+  // 索引のリストから外す．
+  int* p = &mIndex[info.mKey & (mIndex.size() - 1)];
+  while ( *p != cid ) {
+    p = &mClassArray[*p].mLink;
+  }
+  *p = info.mLink;
+
+  info.mKey = key;
+  info.mKeyEnd = key_end;
+  SizeType pos = key & (mIndex.size() - 1);
+  info.mLink = mIndex[pos];
+  mIndex[pos] = cid;
+}
+
+// @brief 新しいクラスを作る．
+// @param[in] node 先頭のノード
+// @param[in] key 索引のキー
+// @param[in] key_end key の計算に用いたワード数
+// @return クラス番号を返す．
+int
+EqClassMgr::new_class(FraigNode* node,
+		      SizeType key,
+		      int key_end)
+{
+  int cid = mClassArray.size();
+  mClassArray.push_back(ClassInfo{node, node, 1, key, key_end, -1});
+  node->mClassId = cid;
+  set_link(node->id(), -1);
+
+  if ( mClassArray.size() > mIndex.size() ) {
+    resize_index();
+  }
+  else {
+    SizeType pos = key & (mIndex.size() - 1);
+    mClassArray[cid].mLink = mIndex[pos];
+    mIndex[pos] = cid;
+  }
+  return cid;
+}
+
+// @brief クラスの末尾にノードを追加する．
+// @param[in] cid クラス番号
+// @param[in] node 追加するノード
+void
+EqClassMgr::add_node(int cid,
+		     FraigNode* node)
+{
+  ClassInfo& info = mClassArray[cid];
+  set_link(info.mTail->id(), node->id());
+  info.mTail = node;
+  ++ info.mNum;
+  node->mClassId = cid;
+  set_link(node->id(), -1);
+}
+
+// @brief 索引を拡大する．
+void
+EqClassMgr::resize_index()
+{
+  int new_size = mIndex.size() * 2;
+  mIndex.clear();
+  mIndex.resize(new_size, -1);
+  int n = mClassArray.size();
+  for ( int cid = 0; cid < n; ++ cid ) {
+    ClassInfo& info = mClassArray[cid];
+    SizeType pos = info.mKey & (new_size - 1);
+    info.mLink = mIndex[pos];
+    mIndex[pos] = cid;
+  }
+}
+
+END_NAMESPACE_FRAIG
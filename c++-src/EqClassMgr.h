@@ -0,0 +1,321 @@
+﻿#ifndef EQCLASSMGR_H
+#define EQCLASSMGR_H
+
+/// @file EqClassMgr.h
+/// @brief EqClassMgr のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "ym/fraig.h"
+#include "ym/FraigHandle.h"
+#include <unordered_map>
+
+
+BEGIN_NAMESPACE_FRAIG
+
+class FraigNode;
+class FraigMgrImpl;
+
+//////////////////////////////////////////////////////////////////////
+/// @class EqClassMgr EqClassMgr.h "EqClassMgr.h"
+/// @brief 等価候補グループ(クラス)を管理するクラス
+///
+/// 確定したパタン(0 ワードめから mgr.pat_used() - 1 ワードめまで)が
+/// 極性を除いて等しいノードを一つのクラスにまとめる．
+/// クラスの要素はノード番号をキーにした mLinkArray でつながったリストで表す．
+///
+/// パタンが追加されても要素数が2以上のクラスだけを
+/// 追加されたワードで分割(refine)すればよい．
+///
+/// クラスの検索には 0 ワードめからのパタンから計算したキーを用いる．
+/// 最初は初期パタンの先頭の数ワードのみからキーを計算し，
+/// 同じキーのクラスが複数になる時はそのキーのクラスを全て
+/// 確定したパタン全体から計算したキーに付け替えて，
+/// 付け替えたワードの範囲を分割の記録に残す．
+/// 検索では分割の記録をたどってキーを延ばしていくので，
+/// ハッシュ値が衝突しない限り1つのキーには1つのクラスしかない．
+/// 要素数が1のクラスのキーは付け替えるまで古いままでよい．
+//////////////////////////////////////////////////////////////////////
+class EqClassMgr
+{
+public:
+
+  /// @brief コンストラクタ
+  EqClassMgr();
+
+  /// @brief デストラクタ
+  ~EqClassMgr();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 論理的に等価なノードを探す．
+  /// @param[in] node 対象のノード
+  /// @param[in] mgr FraigMgr
+  /// @param[out] ans 答のハンドル
+  /// @retval true ノードが見つかった．
+  /// @retval false ノードが見つからなかった．
+  ///
+  /// 見つからなかった場合には node をパタンの等しいクラスに追加する．
+  bool
+  find(FraigNode* node,
+       FraigMgrImpl& mgr,
+       FraigHandle& ans);
+
+  /// @brief パタンの等しいクラスにノードを加える．
+  /// @param[in] node 対象のノード
+  /// @param[in] mgr FraigMgr
+  ///
+  /// find() と異なり論理的な等価性は調べない．
+  /// ガーベージコレクションの後でクラスを作り直す時に用いる．
+  void
+  add(FraigNode* node,
+      FraigMgrImpl& mgr);
+
+  /// @brief 内容を空にする．
+  void
+  clear();
+
+  /// @brief 追加されたワードでクラスを分割する．
+  /// @param[in] mgr FraigMgr
+  /// @param[in] start 開始位置
+  /// @param[in] end 終了位置
+  ///
+  /// 要素数が2以上のクラスのみを対象とする．
+  void
+  refine(FraigMgrImpl& mgr,
+	 int start,
+	 int end);
+
+  /// @brief クラス数を返す．
+  int
+  class_num() const;
+
+  /// @brief 要素数が2以上のクラス数を返す．
+  int
+  nontrivial_num() const;
+
+  /// @brief 要素数が2以上のクラスの先頭ノードを返す．
+  /// @param[in] pos 位置 ( 0 <= pos < nontrivial_num() )
+  FraigNode*
+  nontrivial_top(int pos) const;
+
+  /// @brief 同じクラスの次の要素のノード番号を返す．
+  /// @param[in] id ノード番号
+  ///
+  /// 末尾の場合は -1 を返す．
+  int
+  next_id(int id) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // クラスの情報
+  struct ClassInfo
+  {
+    // 先頭のノード
+    FraigNode* mTop;
+
+    // 末尾のノード
+    FraigNode* mTail;
+
+    // 要素数
+    int mNum;
+
+    // 索引のキー
+    SizeType mKey;
+
+    // キーの計算に用いたワード数
+    int mKeyEnd;
+
+    // 索引の次の要素の番号
+    int mLink;
+  };
+
+  // 分割の記録
+  struct SplitInfo
+  {
+    // 分割したキーの計算に用いたワード数
+    int mStart;
+
+    // 付け替えたキーの計算に用いたワード数
+    int mEnd;
+  };
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief パタンの等しいクラスを探す．
+  /// @param[in] node 対象のノード
+  /// @param[in] mgr FraigMgr
+  /// @param[out] key 最後に調べたキー
+  /// @param[out] key_end key の計算に用いたワード数
+  /// @return クラス番号を返す．
+  ///
+  /// 見つからなかった場合は -1 を返す．
+  int
+  search(FraigNode* node,
+	 FraigMgrImpl& mgr,
+	 SizeType& key,
+	 int& key_end);
+
+  /// @brief search() で見つからなかったノードのクラスを作る．
+  /// @param[in] node 先頭のノード
+  /// @param[in] mgr FraigMgr
+  /// @param[in] key search() で最後に調べたキー
+  /// @param[in] key_end key の計算に用いたワード数
+  /// @return クラス番号を返す．
+  ///
+  /// 同じキーのクラスが既にある場合はキーを分割してから作る．
+  int
+  add_class(FraigNode* node,
+	    FraigMgrImpl& mgr,
+	    SizeType key,
+	    int key_end);
+
+  /// @brief キーの等しいクラスを長いパタンから計算したキーに付け替える．
+  /// @param[in] mgr FraigMgr
+  /// @param[in] key 分割するキー
+  /// @param[in] start key の計算に用いたワード数
+  /// @param[in] end 付け替えるキーの計算に用いるワード数
+  /// @return 付け替えた時 true を返す．
+  ///
+  /// 別の範囲で分割されたキーと衝突した時は付け替えない．
+  bool
+  split(FraigMgrImpl& mgr,
+	SizeType key,
+	int start,
+	int end);
+
+  /// @brief クラスのキーを付け替える．
+  /// @param[in] cid クラス番号
+  /// @param[in] key 新しいキー
+  /// @param[in] key_end key の計算に用いたワード数
+  void
+  rekey(int cid,
+	SizeType key,
+	int key_end);
+
+  /// @brief 新しいクラスを作る．
+  /// @param[in] node 先頭のノード
+  /// @param[in] key 索引のキー
+  /// @param[in] key_end key の計算に用いたワード数
+  /// @return クラス番号を返す．
+  int
+  new_class(FraigNode* node,
+	    SizeType key,
+	    int key_end);
+
+  /// @brief クラスの末尾にノードを追加する．
+  /// @param[in] cid クラス番号
+  /// @param[in] node 追加するノード
+  void
+  add_node(int cid,
+	   FraigNode* node);
+
+  /// @brief 次の要素へのリンクを設定する．
+  /// @param[in] id ノード番号
+  /// @param[in] next 次の要素のノード番号(末尾の場合は -1)
+  void
+  set_link(int id,
+	   int next);
+
+  /// @brief 索引を拡大する．
+  void
+  resize_index();
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // クラスの配列
+  vector<ClassInfo> mClassArray;
+
+  // キーをハッシュ値とした索引
+  // 各要素はクラスのリストの先頭の番号(空の場合は -1)
+  vector<int> mIndex;
+
+  // 分割したキーをキーにした分割の記録
+  std::unordered_map<SizeType, SplitInfo> mSplitMap;
+
+  // 要素数が2以上のクラス番号のリスト
+  vector<int> mNonTrivialList;
+
+  // ノード番号をキーにして同じクラスの次の要素の番号を持つ配列
+  vector<int> mLinkArray;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief クラス数を返す．
+inline
+int
+EqClassMgr::class_num() const
+{
+  return mClassArray.size();
+}
+
+// @brief 要素数が2以上のクラス数を返す．
+inline
+int
+EqClassMgr::nontrivial_num() const
+{
+  return mNonTrivialList.size();
+}
+
+// @brief 要素数が2以上のクラスの先頭ノードを返す．
+inline
+FraigNode*
+EqClassMgr::nontrivial_top(int pos) const
+{
+  ASSERT_COND( pos >= 0 && pos < nontrivial_num() );
+
+  return mClassArray[mNonTrivialList[pos]].mTop;
+}
+
+// @brief 同じクラスの次の要素のノード番号を返す．
+inline
+int
+EqClassMgr::next_id(int id) const
+{
+  int n = mLinkArray.size();
+  if ( id < n ) {
+    return mLinkArray[id];
+  }
+  return -1;
+}
+
+// @brief 次の要素へのリンクを設定する．
+inline
+void
+EqClassMgr::set_link(int id,
+		     int next)
+{
+  int n = mLinkArray.size();
+  if ( id >= n ) {
+    mLinkArray.resize(id + 1, -1);
+  }
+  mLinkArray[id] = next;
+}
+
+END_NAMESPACE_FRAIG
+
+#endif // EQCLASSMGR_H
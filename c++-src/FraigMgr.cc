@@ -10,10 +10,15 @@
 #include "ym/FraigMgr.h"
 #include "FraigMgrImpl.h"
 #include "FraigNode.h"
+#include "AigReader.h"
+#include "AigWriter.h"
 #include "ym/BnNetwork.h"
 #include "ym/BnNode.h"
 #include "ym/BnNodeType.h"
 #include "ym/Range.h"
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
 
 
 #if defined(YM_DEBUG)
@@ -51,6 +56,74 @@ FraigMgr::~FraigMgr()
 {
 }
 
+// @brief 外部入力数を得る．
+int
+FraigMgr::input_num() const
+{
+  return mRep->input_num();
+}
+
+// @brief 外部入力のハンドルを得る．
+FraigHandle
+FraigMgr::input_handle(int pos) const
+{
+  return FraigHandle(mRep->input_node(pos)->id(), false);
+}
+
+// @brief 外部入力ノードへのハンドルのとき true を返す．
+bool
+FraigMgr::is_input(FraigHandle handle) const
+{
+  if ( handle.is_const() ) {
+    return false;
+  }
+  return mRep->node(handle.node_id())->is_input();
+}
+
+// @brief 外部入力ノードへのハンドルのとき，入力番号を返す．
+int
+FraigMgr::input_id(FraigHandle handle) const
+{
+  if ( !is_input(handle) ) {
+    return 0;
+  }
+  return mRep->node(handle.node_id())->input_id();
+}
+
+// @brief ANDノードへのハンドルのとき true を返す．
+bool
+FraigMgr::is_and(FraigHandle handle) const
+{
+  if ( handle.is_const() ) {
+    return false;
+  }
+  return mRep->node(handle.node_id())->is_and();
+}
+
+// @brief ANDノードのファンインのハンドルを得る．
+FraigHandle
+FraigMgr::fanin_handle(FraigHandle handle,
+		       int pos) const
+{
+  ASSERT_COND( is_and(handle) );
+
+  return mRep->fanin_handle(mRep->node(handle.node_id()), pos);
+}
+
+// @brief 代表ハンドルを得る．
+FraigHandle
+FraigMgr::rep_handle(FraigHandle handle) const
+{
+  if ( handle.is_const() ) {
+    return handle;
+  }
+  FraigHandle ans = mRep->node(handle.node_id())->rep_handle();
+  if ( handle.inv() ) {
+    ans = ~ans;
+  }
+  return ans;
+}
+
 // @brief 外部入力を作る．
 FraigHandle
 FraigMgr::make_input()
@@ -121,38 +194,125 @@ FraigMgr::make_cofactor(FraigHandle edge,
 			int input_id,
 			bool inv)
 {
-  if ( edge.is_const() ) {
-    // edge が定数の時は変更なし
-    return edge;
-  }
+  FraigHandle val = inv ? make_zero() : make_one();
+  return compose(edge, vector<pair<int, FraigHandle>>{{input_id, val}});
+}
+
+// @brief 入力を他のハンドルで置き換えた関数を作る．
+// @param[in] edge 対象の AIG ハンドル
+// @param[in] comp_list (入力番号, 置き換えるハンドル)のリスト
+FraigHandle
+FraigMgr::compose(FraigHandle edge,
+		  const vector<pair<int, FraigHandle>>& comp_list)
+{
+  vector<FraigHandle> output_list;
+  compose(vector<FraigHandle>{edge}, comp_list, output_list);
+  return output_list[0];
+}
 
-  FraigNode* node = edge.node();
-  FraigHandle ans;
-  if ( node->is_input() ) {
-    // 入力ノード時は番号が input_id どうかで処理が変わる．
-    if ( node->input_id() == input_id ) {
-      if ( inv ) {
-	ans = make_zero();
+// @brief 複数のハンドルについて入力を他のハンドルで置き換えた関数を作る．
+// @param[in] edge_list 対象の AIG ハンドルのリスト
+// @param[in] comp_list (入力番号, 置き換えるハンドル)のリスト
+// @param[out] output_list 結果のハンドルのリスト
+void
+FraigMgr::compose(const vector<FraigHandle>& edge_list,
+		  const vector<pair<int, FraigHandle>>& comp_list,
+		  vector<FraigHandle>& output_list)
+{
+  // ノード番号をキーにして結果のハンドルを持つ表
+  std::unordered_map<int, FraigHandle> h_map;
+
+  // 1. ファンインコーンのノードを集める．
+  //    再収斂があっても各ノードは一度しか現れない．
+  vector<int> id_list;
+  vector<int> id_stack;
+  for ( auto edge: edge_list ) {
+    if ( !edge.is_const() && h_map.count(edge.node_id()) == 0 ) {
+      h_map.emplace(edge.node_id(), FraigHandle());
+      id_stack.push_back(edge.node_id());
+    }
+  }
+  while ( !id_stack.empty() ) {
+    int id = id_stack.back();
+    id_stack.pop_back();
+    id_list.push_back(id);
+    FraigNode* node = mRep->node(id);
+    if ( node->is_and() ) {
+      for ( int pos: { 0, 1 } ) {
+	int iid = node->fanin_id(pos);
+	if ( h_map.count(iid) == 0 ) {
+	  h_map.emplace(iid, FraigHandle());
+	  id_stack.push_back(iid);
+	}
       }
-      else {
-	ans = make_one();
+    }
+  }
+
+  // 2. ファンインは常に自分より小さい番号なので
+  //    ノード番号の順に処理すればファンインの結果は求まっている．
+  //    途中で作られるノードは id_list に含まれないので影響しない．
+  std::sort(id_list.begin(), id_list.end());
+  std::unordered_map<int, FraigHandle> comp_map(comp_list.begin(), comp_list.end());
+  for ( auto id: id_list ) {
+    FraigNode* node = mRep->node(id);
+    FraigHandle ans(id, false);
+    if ( node->is_input() ) {
+      auto p = comp_map.find(node->input_id());
+      if ( p != comp_map.end() ) {
+	ans = p->second;
       }
     }
     else {
-      ans = FraigHandle(node, false);
+      FraigHandle handle0 = mRep->fanin_handle(node, 0);
+      FraigHandle handle1 = mRep->fanin_handle(node, 1);
+      FraigHandle new_handle0 = h_map[handle0.node_id()];
+      FraigHandle new_handle1 = h_map[handle1.node_id()];
+      if ( handle0.inv() ) {
+	new_handle0 = ~new_handle0;
+      }
+      if ( handle1.inv() ) {
+	new_handle1 = ~new_handle1;
+      }
+      if ( new_handle0 != handle0 || new_handle1 != handle1 ) {
+	// ファンインが変わらなければ作り直す必要はない．
+	ans = make_and(new_handle0, new_handle1);
+      }
     }
+    h_map[id] = ans;
   }
-  else {
-    // AND ノードの場合
-    // 2つの子供に再帰的な処理を行って結果の AND を計算する．
-    FraigHandle new_handle0 = make_cofactor(node->fanin0_handle(), input_id, inv);
-    FraigHandle new_handle1 = make_cofactor(node->fanin1_handle(), input_id, inv);
-    FraigHandle ans = make_and(new_handle0, new_handle1);
-  }
-  if ( edge.inv() ) {
-    ans = ~ans;
+
+  output_list.clear();
+  output_list.reserve(edge_list.size());
+  for ( auto edge: edge_list ) {
+    FraigHandle ans = edge;
+    if ( !edge.is_const() ) {
+      ans = h_map[edge.node_id()];
+      if ( edge.inv() ) {
+	ans = ~ans;
+      }
+    }
+    output_list.push_back(ans);
   }
-  return ans;
+}
+
+// @brief 入力を存在量化した関数を作る．
+// @param[in] edge 対象の AIG ハンドル
+// @param[in] input_list 量化する入力番号のリスト
+FraigHandle
+FraigMgr::exists(FraigHandle edge,
+		 const vector<int>& input_list)
+{
+  return mRep->quantify(edge, input_list, false);
+}
+
+// @brief 入力を全称量化した関数を作る．
+// @param[in] edge 対象の AIG ハンドル
+// @param[in] input_list 量化する入力番号のリスト
+FraigHandle
+FraigMgr::forall(FraigHandle edge,
+		 const vector<int>& input_list)
+{
+  return mRep->quantify(edge, input_list, true);
 }
 
 // @brief BnNetwork をインポートする．
@@ -269,6 +429,157 @@ FraigMgr::import_subnetwork(const BnNetwork& network,
   }
 }
 
+// @brief バイナリ AIGER 形式のファイルをインポートする．
+// @param[in] filename ファイル名
+// @param[inout] input_handles ファイルの入力に接続するハンドルのリスト
+// @param[out] output_handles ファイルの出力に対応したハンドルのリスト
+// @param[in] deferred true の時は読み込みの間 SAT を用いない．
+// @return 読み込みに成功したら true を返す．
+bool
+FraigMgr::import_aig(const string& filename,
+		     vector<FraigHandle>& input_handles,
+		     vector<FraigHandle>& output_handles,
+		     bool deferred)
+{
+  AigReader reader;
+  if ( !reader.open(filename) ) {
+    return false;
+  }
+
+  int ni = reader.input_num();
+  if ( input_handles.empty() ) {
+    input_handles.reserve(ni);
+    for ( int i = 0; i < ni; ++ i ) {
+      input_handles.push_back(make_input());
+    }
+  }
+  else if ( input_handles.size() != static_cast<SizeType>(ni) ) {
+    return false;
+  }
+
+  // deferred の時は読み込みの間だけバッチモードにする．
+  bool old_mode = mRep->batch_mode();
+  int sim_words = mRep->batch_sim_words();
+  if ( deferred ) {
+    mRep->set_batch_mode(true, sim_words);
+  }
+  bool stat = reader.read(*mRep, input_handles, output_handles);
+  mRep->set_batch_mode(old_mode, sim_words);
+
+  return stat;
+}
+
+// @brief 出力のファンインコーンをバイナリ AIGER 形式で書き出す．
+// @param[in] filename ファイル名
+// @param[in] output_handles 出力のハンドルのリスト
+// @return 書き出しに成功したら true を返す．
+bool
+FraigMgr::export_aig(const string& filename,
+		     const vector<FraigHandle>& output_handles) const
+{
+  ofstream ofs(filename, std::ios::binary);
+  if ( !ofs ) {
+    return false;
+  }
+  export_aig(ofs, output_handles);
+  ofs.close();
+  return !ofs.fail();
+}
+
+// @brief 出力のファンインコーンをバイナリ AIGER 形式で書き出す．
+// @param[in] s 出力先のストリーム
+// @param[in] output_handles 出力のハンドルのリスト
+void
+FraigMgr::export_aig(ostream& s,
+		     const vector<FraigHandle>& output_handles) const
+{
+  AigWriter writer(*mRep, output_handles);
+  writer.write_aig(s);
+}
+
+// @brief 出力のファンインコーンを BnNetwork に書き出す．
+// @param[in] output_handles 出力のハンドルのリスト
+// @param[out] network 結果のネットワーク
+void
+FraigMgr::export_network(const vector<FraigHandle>& output_handles,
+			 BnNetwork& network) const
+{
+  AigWriter writer(*mRep, output_handles);
+
+  network.clear();
+
+  // AIGER の変数番号をキーにしてノード番号を持つ表
+  // inv_map は否定のノード番号を持つ．-1 はまだ作っていないことを表す．
+  int ni = writer.input_num();
+  SizeType na = writer.and_num();
+  vector<int> id_map(ni + na + 1, -1);
+  vector<int> inv_map(ni + na + 1, -1);
+
+  for ( auto i: Range(ni) ) {
+    int port_id = network.new_input_port("i" + std::to_string(i), 1);
+    id_map[i + 1] = network.port(port_id).bit(0);
+  }
+
+  // リテラルに対応するノード番号を返す．
+  // 定数は出力にのみ現れ，定数0 は id_map[0] に，定数1 は inv_map[0] に
+  // 必要になった時に作る．
+  auto lit_id = [&](SizeType lit) {
+    SizeType var = lit >> 1;
+    if ( var == 0 ) {
+      int& id = (lit & 1) ? inv_map[0] : id_map[0];
+      if ( id == -1 ) {
+	if ( lit & 1 ) {
+	  id = network.new_logic("c1", BnNodeType::C1, 0);
+	}
+	else {
+	  id = network.new_logic("c0", BnNodeType::C0, 0);
+	}
+      }
+      return id;
+    }
+    if ( (lit & 1) == 0 ) {
+      return id_map[var];
+    }
+    if ( inv_map[var] == -1 ) {
+      string name = "n" + std::to_string(var) + "_n";
+      inv_map[var] = network.new_logic(name, BnNodeType::Not, 1);
+      network.connect(id_map[var], inv_map[var], 0);
+    }
+    return inv_map[var];
+  };
+
+  for ( SizeType pos = 0; pos < na; ++ pos ) {
+    SizeType var = ni + pos + 1;
+    SizeType lit0 = writer.and_fanin_lit(pos, 0);
+    SizeType lit1 = writer.and_fanin_lit(pos, 1);
+    string name = "n" + std::to_string(var);
+    int id;
+    if ( (lit0 & 1) && (lit1 & 1) ) {
+      // 両方とも否定なら否定のノードを作らずに NOR にする．
+      id = network.new_logic(name, BnNodeType::Nor, 2);
+      network.connect(id_map[lit0 >> 1], id, 0);
+      network.connect(id_map[lit1 >> 1], id, 1);
+    }
+    else {
+      int id0 = lit_id(lit0);
+      int id1 = lit_id(lit1);
+      id = network.new_logic(name, BnNodeType::And, 2);
+      network.connect(id0, id, 0);
+      network.connect(id1, id, 1);
+    }
+    id_map[var] = id;
+  }
+
+  int no = writer.output_num();
+  for ( auto i: Range(no) ) {
+    int src_id = lit_id(writer.output_lit(i));
+    int port_id = network.new_output_port("o" + std::to_string(i), 1);
+    network.connect(src_id, network.port(port_id).bit(0), 0);
+  }
+
+  network.wrap_up();
+}
+
 // @brief 複数のノードの AND を取る．
 // @param[in] edge_list 入力の AIG ハンドルのリスト
 // @param[in] start_pos 開始位置
@@ -327,6 +638,20 @@ FraigMgr::_make_xor(const vector<FraigHandle>& edge_list,
   return make_xor(h0, h1);
 }
 
+// @brief 使われていないノードを削除する．
+void
+FraigMgr::garbage_collect(vector<FraigHandle>& handle_list)
+{
+  mRep->garbage_collect(handle_list);
+}
+
+// @brief SAT スイープを行う．
+void
+FraigMgr::sweep(vector<FraigHandle>& handle_list)
+{
+  mRep->sweep(handle_list);
+}
+
 // @brief 2つのハンドルが等価かどうか調べる．
 SatBool3
 FraigMgr::check_equiv(FraigHandle aig1,
@@ -356,6 +681,88 @@ FraigMgr::set_loop_limit(int val)
   mRep->set_loop_limit(val);
 }
 
+// @brief シミュレーションと sweep() に用いるスレッド数を設定する．
+void
+FraigMgr::set_thread_num(int num)
+{
+  mRep->set_thread_num(num);
+}
+
+// @brief check_const で用いる SAT の予算を設定する．
+void
+FraigMgr::set_check_const_limit(SizeType conflict_limit,
+				SizeType propagation_limit,
+				int time_limit)
+{
+  mRep->set_check_const_limit(conflict_limit, propagation_limit, time_limit);
+}
+
+// @brief check_equiv で用いる SAT の予算を設定する．
+void
+FraigMgr::set_check_equiv_limit(SizeType conflict_limit,
+				SizeType propagation_limit,
+				int time_limit)
+{
+  mRep->set_check_equiv_limit(conflict_limit, propagation_limit, time_limit);
+}
+
+// @brief sweep() で用いる SAT の予算を設定する．
+void
+FraigMgr::set_sweep_limit(SizeType conflict_limit,
+			  SizeType propagation_limit,
+			  int time_limit)
+{
+  mRep->set_sweep_limit(conflict_limit, propagation_limit, time_limit);
+}
+
+// @brief 一度アボートした検査を再び行わないかどうかを設定する．
+void
+FraigMgr::set_skip_aborted(bool flag)
+{
+  mRep->set_skip_aborted(flag);
+}
+
+// @brief 等価検査をミタ回路を用いた1回の SAT で行うかどうかを設定する．
+void
+FraigMgr::set_miter_check(bool flag)
+{
+  mRep->set_miter_check(flag);
+}
+
+// @brief 構築中の検査を sweep() にまとめるかどうかを設定する．
+void
+FraigMgr::set_batch_mode(bool flag,
+			 int sim_words)
+{
+  mRep->set_batch_mode(flag, sim_words);
+}
+
+// @brief SAT ソルバを作り直す条件を設定する．
+void
+FraigMgr::set_rebuild_limit(SizeType clause_limit,
+			    SizeType var_limit,
+			    double time_ratio)
+{
+  mRep->set_rebuild_limit(clause_limit, var_limit, time_ratio);
+}
+
+// @brief ポートフォリオに用いる SAT ソルバを設定する．
+void
+FraigMgr::set_portfolio(const vector<SatSolverType>& type_list,
+			SizeType conflict_limit,
+			SizeType propagation_limit,
+			int time_limit)
+{
+  mRep->set_portfolio(type_list, conflict_limit, propagation_limit, time_limit);
+}
+
+// @brief SAT ソルバに CNF の前処理を行わせる．
+void
+FraigMgr::preprocess_cnf()
+{
+  mRep->preprocess_cnf();
+}
+
 // @brief 内部の統計情報を出力する．
 void
 FraigMgr::dump_stats(ostream& s)
@@ -363,4 +770,18 @@ FraigMgr::dump_stats(ostream& s)
   mRep->dump_stats(s);
 }
 
+// @brief ポートフォリオのソルバを競争させた回数を返す．
+int
+FraigMgr::race_count() const
+{
+  return mRep->race_count();
+}
+
+// @brief ランダムシミュレーションで加えたパタンのワード数を返す．
+int
+FraigMgr::sim_count() const
+{
+  return mRep->sim_count();
+}
+
 END_NAMESPACE_FRAIG
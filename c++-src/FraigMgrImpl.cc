@@ -9,9 +9,18 @@
 
 #include "FraigMgrImpl.h"
 #include "FraigNode.h"
+#include "SimKernel.h"
+#include "SimEngine.h"
+#include "SweepWorker.h"
 #include "ym/Range.h"
 #include "ym/Timer.h"
 #include "ym/SatStats.h"
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iterator>
+#include <unordered_map>
 
 
 #if defined(YM_DEBUG)
@@ -29,6 +38,23 @@ BEGIN_NONAMESPACE
 
 const int debug = DEBUG_FLAG;
 
+// SAT ソルバの作り直しの判定に用いる区間の検査回数
+const int kRebuildWindow = 256;
+
+// sweep() で1スレッドが一度に受け持つ検査の数
+const int kSweepBatch = 16;
+
+// 最初にクラスのキーの計算に用いるワード数
+const int kKeySize = 8;
+
+// 真理値表で検査するサポート数の上限
+// 2^16 パタンは 1024 ワードになる．
+const int kMaxSupport = 16;
+
+// 真理値表の検査で用いる作業領域のワード数の上限
+// サポートが小さくてもファンインコーンが大きい場合は SAT に任せる．
+const SizeType kMaxTruthTableWords = 1 << 20;
+
 END_NONAMESPACE
 
 //////////////////////////////////////////////////////////////////////
@@ -40,23 +66,49 @@ END_NONAMESPACE
 // @param[in] solver_type SAT-solver の種類を表すオブジェクト
 FraigMgrImpl::FraigMgrImpl(int sig_size,
 			   const SatSolverType& solver_type) :
-  mPatSize(sig_size * 2),
+  mNodeNum(0),
   mPatInit(sig_size),
   mPatUsed(sig_size),
-  mSolver(solver_type),
+  mCexNum(0),
+  mCexStamp(1),
+  mSimEngine(mPatMgr),
+  mRandSeed(mRandGen()),
+  mSolverType(solver_type),
+  mSolver(new SatSolver(solver_type)),
+  mDeadVarNum(0),
+  mFrozenNum(0),
+  mRebuildInfo{0, 0, 0.0, 0, 0.0, 0, 0, 0.0, -1.0, 0.0, -1.0, 0.0},
+  mPortfolio{{}, {0, 0, 0}, 0, 0, 0.0, {}, {}, {}},
+  mLastCexValid(false),
+  mQuantifyInfo{0, 0, 0, 0, 0.0},
   mSimCount(0),
   mSimTime(0.0),
+  mSimStreak(0),
+  mCheckConstLimit{0, 0, 0},
+  mCheckEquivLimit{0, 0, 0},
+  mSweepLimit{0, 0, 0},
+  mSkipAborted(true),
+  mMiterCheck(false),
+  mBatchMode(false),
+  mBatchSimWords(32),
+  mBatchPending(false),
   mLogLevel(0),
   mLogStream(new ofstream("/dev/null")),
   mLoopLimit(1000)
 {
+  mPatMgr.reserve(sig_size * 2);
+
+  // ノード番号 0 は定数ノード用に予約しておく．
+  // FraigHandle のリテラル 0 と 1 が定数0と定数1を表す．
+  // このノードのパタンや CNF が参照されることはない．
+  new_node();
 }
 
 // @brief デストラクタ
 FraigMgrImpl::~FraigMgrImpl()
 {
-  for ( auto node: mAllNodes ) {
-    delete node;
+  for ( auto page: mNodePageList ) {
+    delete [] page;
   }
   if ( mLogStream != &cout ) {
     delete mLogStream;
@@ -75,13 +127,16 @@ FraigMgrImpl::make_input()
   int iid = mInputNodes.size();
   node->set_input(iid);
   mInputNodes.push_back(node);
-  vector<ymuint64> tmp(mPatUsed);
-  std::uniform_int_distribution<ymuint64> rd;
-  for ( int i: Range(mPatUsed) ) {
-    tmp[i] = rd(mRandGen);
+  calc_support(node);
+  // 初期パタンはスレッド数によらず同じになるように
+  // (乱数の種, ノード番号, ワード位置)から決まる乱数を用いる．
+  mSimEngine.set_random(node, 0, mPatUsed, mRandSeed);
+  if ( mCexNum > 0 ) {
+    // 保留中の反例のワードには乱数を入れておく．
+    std::uniform_int_distribution<ymuint64> rd;
+    mPatMgr.word(node->id(), mPatUsed) = rd(mRandGen);
   }
-  node->set_pat(0, mPatUsed, tmp);
-  FraigHandle ans = FraigHandle(node, false);
+  FraigHandle ans = FraigHandle(node->id(), false);
 
   if ( debug ) {
     cout << " -> " << ans << endl;
@@ -115,13 +170,13 @@ FraigMgrImpl::make_and(FraigHandle handle1,
   else if ( handle1 == handle2 ) {
     ans = handle1;
   }
-  else if ( handle1.node() == handle2.node() ) {
+  else if ( handle1.node_id() == handle2.node_id() ) {
     // handle1.inv != handle2.inv() のはず
     ans = FraigHandle::zero();
   }
   else {
     // 順番の正規化
-    if ( handle1.literal().varid() < handle2.literal().varid() ) {
+    if ( handle1.node_id() < handle2.node_id() ) {
       FraigHandle tmp = handle1;
       handle1 = handle2;
       handle2 = tmp;
@@ -132,28 +187,37 @@ FraigMgrImpl::make_and(FraigHandle handle1,
     }
 
     // 同じ構造を持つノードが既にないか調べる．
-    if ( !mHashTable1.find(handle1, handle2, ans) ) {
+    ymuint32 lit1 = handle1.lit();
+    ymuint32 lit2 = handle2.lit();
+    int id = mHashTable1.find(lit1, lit2);
+    if ( id != -1 ) {
+      ans = node(id)->rep_handle();
+    }
+    else {
       // ノードを作る．
       FraigNode* node = new_node();
       node->set_fanin(handle1, handle2);
-      node->calc_pat(0, mPatUsed);
+      calc_support(node);
+      update_pat(node, mPatUsed);
 
       // 構造ハッシュに追加する．
-      mHashTable1.add(node);
-
-      // 入出力の関係を表す CNF を作る．
-      make_cnf(node);
+      mHashTable1.add(lit1, lit2, node->id());
 
       if ( debug ) {
-	cout << "  new node: " << FraigHandle(node, false) << endl;
+	cout << "  new node: " << FraigHandle(node->id(), false) << endl;
       }
 
+      if ( mBatchMode ) {
+	// 検査は sweep() でまとめて行うのでクラスに加えるだけにする．
+	mClassMgr.add(node, *this);
+	mBatchPending = true;
+	ans = FraigHandle(node->id(), false);
+      }
       // 縮退検査を行う．
-      if ( verify_const(node, ans) != SatBool3::True ) {
-	// パタンハッシュで等しいノードがないか調べる．
-	if ( !mHashTable2.find(node, *this, ans) ) {
-	  mHashTable2.add(node);
-	  ans = FraigHandle(node, false);
+      else if ( verify_const(node, ans) != SatBool3::True ) {
+	// 等価候補グループから等しいノードを探す．
+	if ( !mClassMgr.find(node, *this, ans) ) {
+	  ans = FraigHandle(node->id(), false);
 	}
       }
     }
@@ -166,18 +230,775 @@ FraigMgrImpl::make_and(FraigHandle handle1,
   return ans;
 }
 
+// @brief 入力を量化した関数を作る．
+// @param[in] edge 対象の AIG ハンドル
+// @param[in] input_list 量化する入力番号のリスト
+// @param[in] forall 全称量化の時 true，存在量化の時 false にする．
+FraigHandle
+FraigMgrImpl::quantify(FraigHandle edge,
+		       const vector<int>& input_list,
+		       bool forall)
+{
+  Timer timer;
+  timer.start();
+
+  ++ mQuantifyInfo.mCallCount;
+
+  // 消去していない入力のリスト
+  vector<int> var_list;
+  {
+    std::unordered_set<int> var_set;
+    for ( auto id: input_list ) {
+      ASSERT_COND( id >= 0 && id < input_num() );
+      if ( var_set.count(id) == 0 ) {
+	var_set.insert(id);
+	var_list.push_back(id);
+      }
+    }
+  }
+
+  // 入力の位置は最初の var_list での位置で固定する．
+  // alive_mask はまだ消去していない入力のビットを持つ．
+  int nv = var_list.size();
+  int nw = (nv + 63) / 64;
+  std::unordered_map<int, int> var_pos;
+  vector<ymuint64> alive_mask(nw, 0ULL);
+  for ( int k = 0; k < nv; ++ k ) {
+    var_pos.emplace(var_list[k], k);
+    alive_mask[k / 64] |= (1ULL << (k % 64));
+  }
+  int alive_num = nv;
+
+  // node_list と依存する入力のビットベクタ dep は入力を消去するたびに
+  // 作り直さず，新しく現れたノードの分だけ末尾に追加していく．
+  // 追加するノードのファンインは既に表にあるか同時に追加される
+  // より小さい番号のノードなので node_list はトポロジカル順になる．
+  // node_pos はノード番号から node_list 中の位置を引く表
+  vector<FraigNode*> node_list;
+  std::unordered_map<int, int> node_pos;
+  vector<ymuint64> dep;
+  vector<int> mark;
+  int stamp = 0;
+  while ( alive_num > 0 && !edge.is_const() ) {
+    // 1. ファンインコーンのうち表にないノードを集めて
+    //    ノード番号の順に表に追加する．
+    {
+      vector<FraigNode*> new_list;
+      vector<FraigNode*> node_stack;
+      if ( node_pos.count(edge.node_id()) == 0 ) {
+	node_pos.emplace(edge.node_id(), -1);
+	node_stack.push_back(node(edge.node_id()));
+      }
+      while ( !node_stack.empty() ) {
+	FraigNode* node1 = node_stack.back();
+	node_stack.pop_back();
+	new_list.push_back(node1);
+	if ( node1->is_and() ) {
+	  for ( int pos: { 0, 1 } ) {
+	    int iid = node1->fanin_id(pos);
+	    if ( node_pos.count(iid) == 0 ) {
+	      node_pos.emplace(iid, -1);
+	      node_stack.push_back(node(iid));
+	    }
+	  }
+	}
+      }
+      std::sort(new_list.begin(), new_list.end(),
+		[](FraigNode* a, FraigNode* b) { return a->id() < b->id(); });
+      for ( auto node1: new_list ) {
+	int i = node_list.size();
+	node_pos[node1->id()] = i;
+	node_list.push_back(node1);
+	dep.resize(static_cast<SizeType>(i + 1) * nw, 0ULL);
+	ymuint64* dst = &dep[static_cast<SizeType>(i) * nw];
+	if ( node1->is_input() ) {
+	  auto p = var_pos.find(node1->input_id());
+	  if ( p != var_pos.end() ) {
+	    int k = p->second;
+	    dst[k / 64] |= (1ULL << (k % 64));
+	  }
+	}
+	else {
+	  int i0 = node_pos.at(node1->fanin0_id());
+	  int i1 = node_pos.at(node1->fanin1_id());
+	  const ymuint64* src0 = &dep[static_cast<SizeType>(i0) * nw];
+	  const ymuint64* src1 = &dep[static_cast<SizeType>(i1) * nw];
+	  for ( int w = 0; w < nw; ++ w ) {
+	    dst[w] = src0[w] | src1[w];
+	  }
+	}
+      }
+    }
+
+    // 2. 今のファンインコーンのノードの表の位置を集めて
+    //    トポロジカル順に並べる．
+    vector<int> cone;
+    {
+      ++ stamp;
+      mark.resize(node_list.size(), 0);
+      int root_pos = node_pos.at(edge.node_id());
+      vector<int> pos_stack{root_pos};
+      mark[root_pos] = stamp;
+      while ( !pos_stack.empty() ) {
+	int i = pos_stack.back();
+	pos_stack.pop_back();
+	cone.push_back(i);
+	FraigNode* node1 = node_list[i];
+	if ( node1->is_and() ) {
+	  for ( int pos: { 0, 1 } ) {
+	    int i1 = node_pos.at(node1->fanin_id(pos));
+	    if ( mark[i1] != stamp ) {
+	      mark[i1] = stamp;
+	      pos_stack.push_back(i1);
+	    }
+	  }
+	}
+      }
+      std::sort(cone.begin(), cone.end());
+    }
+
+    // 3. 未消去の入力ごとに依存するノード数を数える．
+    vector<int> count(nv, 0);
+    for ( int i: cone ) {
+      const ymuint64* src = &dep[static_cast<SizeType>(i) * nw];
+      for ( int w = 0; w < nw; ++ w ) {
+	for ( ymuint64 bits = src[w] & alive_mask[w];
+	      bits != 0ULL; bits &= bits - 1 ) {
+	  ++ count[w * 64 + __builtin_ctzll(bits)];
+	}
+      }
+    }
+
+    // 4. 依存するノード数が最も少ない入力を選ぶ．
+    //    どのノードも依存していない入力は消去しても関数が変わらない．
+    int best = -1;
+    for ( int k = 0; k < nv; ++ k ) {
+      if ( count[k] > 0 && (best == -1 || count[k] < count[best]) ) {
+	best = k;
+      }
+    }
+    if ( best == -1 ) {
+      break;
+    }
+
+    // 5. 両方のコファクターを1回のたどりで作る．
+    //    best に依存しないノードは両方とも自分自身になる．
+    //    途中で作られるノードは cone に含まれないので影響しない．
+    SizeType old_num = node_num();
+    vector<pair<FraigHandle, FraigHandle>> cof_list(node_list.size());
+    for ( int i: cone ) {
+      FraigNode* node1 = node_list[i];
+      if ( (dep[static_cast<SizeType>(i) * nw + best / 64] & (1ULL << (best % 64))) == 0ULL ) {
+	FraigHandle handle(node1->id(), false);
+	cof_list[i] = make_pair(handle, handle);
+      }
+      else if ( node1->is_input() ) {
+	cof_list[i] = make_pair(FraigHandle::zero(), FraigHandle::one());
+      }
+      else {
+	auto cof0 = cof_list[node_pos.at(node1->fanin0_id())];
+	auto cof1 = cof_list[node_pos.at(node1->fanin1_id())];
+	if ( node1->fanin0_inv() ) {
+	  cof0 = make_pair(~cof0.first, ~cof0.second);
+	}
+	if ( node1->fanin1_inv() ) {
+	  cof1 = make_pair(~cof1.first, ~cof1.second);
+	}
+	FraigHandle ans0 = make_and(cof0.first, cof1.first);
+	FraigHandle ans1 = make_and(cof0.second, cof1.second);
+	cof_list[i] = make_pair(ans0, ans1);
+      }
+    }
+    const auto& root_cof = cof_list[node_pos.at(edge.node_id())];
+    FraigHandle root0 = root_cof.first;
+    FraigHandle root1 = root_cof.second;
+    if ( edge.inv() ) {
+      root0 = ~root0;
+      root1 = ~root1;
+    }
+    if ( forall ) {
+      edge = make_and(root0, root1);
+    }
+    else {
+      edge = ~make_and(~root0, ~root1);
+    }
+
+    // 6. ノード数の増加を記録する．
+    //    この間ノードは削除されないので増加分がそのままピークになる．
+    SizeType growth = node_num() - old_num;
+    ++ mQuantifyInfo.mVarCount;
+    mQuantifyInfo.mTotalGrowth += growth;
+    if ( mQuantifyInfo.mMaxGrowth < growth ) {
+      mQuantifyInfo.mMaxGrowth = growth;
+    }
+    if ( mLogLevel > 0 ) {
+      *mLogStream << (forall ? "forall" : "exists")
+		  << ": input#" << var_list[best]
+		  << ", " << count[best] << " / " << cone.size() << " nodes depend"
+		  << ", +" << growth << " nodes" << endl;
+    }
+
+    // 7. 消去した入力と依存するノードのない入力を取り除く．
+    for ( int k = 0; k < nv; ++ k ) {
+      ymuint64 bit = 1ULL << (k % 64);
+      if ( (alive_mask[k / 64] & bit) != 0ULL && (k == best || count[k] == 0) ) {
+	alive_mask[k / 64] &= ~bit;
+	-- alive_num;
+      }
+    }
+  }
+
+  timer.stop();
+  mQuantifyInfo.mTime += timer.get_time();
+
+  return edge;
+}
+
+// @brief 使われていないノードを削除する．
+// @param[in] root_list 使用中のハンドルのリスト
+void
+FraigMgrImpl::garbage_collect(vector<FraigHandle>& root_list)
+{
+  // 1. 入力ノードと root_list から到達可能なノードに印をつける．
+  //    定数ノード(ノード番号 0)は常に残す．
+  //    マージされたノードは代表ノードに置き換えるので
+  //    どこからも参照されなくなる．
+  vector<int> id_map(mNodeNum, -1);
+  vector<int> node_stack;
+  id_map[0] = 0;
+  for ( auto node1: mInputNodes ) {
+    id_map[node1->id()] = 0;
+  }
+  for ( auto& handle: root_list ) {
+    if ( handle.is_const() ) {
+      continue;
+    }
+    FraigHandle rep = node(handle.node_id())->rep_handle();
+    handle = handle.inv() ? ~rep : rep;
+    int id = handle.node_id();
+    if ( id_map[id] == -1 ) {
+      id_map[id] = 0;
+      node_stack.push_back(id);
+    }
+  }
+  while ( !node_stack.empty() ) {
+    FraigNode* node1 = node(node_stack.back());
+    node_stack.pop_back();
+    if ( node1->is_and() ) {
+      for ( int pos: { 0, 1 } ) {
+	int iid = node1->fanin_id(pos);
+	if ( id_map[iid] == -1 ) {
+	  id_map[iid] = 0;
+	  node_stack.push_back(iid);
+	}
+      }
+    }
+  }
+
+  // 2. 残すノードに番号の順序を保ったまま新しい番号を振る．
+  //    ファンインは常に自分より小さい番号になる．
+  int new_num = 0;
+  int live_var_num = 0;
+  for ( int id = 0; id < mNodeNum; ++ id ) {
+    if ( id_map[id] != -1 ) {
+      id_map[id] = new_num;
+      ++ new_num;
+      if ( id > 0 && node(id)->is_loaded() ) {
+	++ live_var_num;
+      }
+    }
+    else if ( node(id)->is_loaded() ) {
+      ++ mDeadVarNum;
+    }
+  }
+  if ( new_num == mNodeNum ) {
+    // 削除するノードはなかった．
+    return;
+  }
+
+  // 3. ノードとパタンを前に詰める．
+  //    新しい番号は元の番号以下なのでまだ移動していないノードを壊すことはない．
+  for ( auto& node1: mInputNodes ) {
+    node1 = node(id_map[node1->id()]);
+  }
+  int nw = std::min(mPatUsed + 1, mPatMgr.capacity());
+  auto map_lit = [&](ymuint32 lit) {
+    return static_cast<ymuint32>(id_map[lit >> 1]) * 2 + (lit & 1U);
+  };
+  for ( int id = 1; id < mNodeNum; ++ id ) {
+    int new_id = id_map[id];
+    if ( new_id == -1 ) {
+      continue;
+    }
+    FraigNode* dst = node(new_id);
+    if ( new_id != id ) {
+      FraigNode* src = node(id);
+      ASSERT_COND( src->rep_handle() == FraigHandle(id, false) );
+      *dst = *src;
+      mPatMgr.copy_node(new_id, id, nw);
+    }
+    dst->mId = new_id;
+    dst->mRepLit = new_id * 2;
+    dst->mClassId = -1;
+    if ( dst->is_and() ) {
+      dst->mFanins[0] = map_lit(dst->mFanins[0]);
+      dst->mFanins[1] = map_lit(dst->mFanins[1]);
+    }
+  }
+  int page_num = (new_num + kPageSize - 1) >> kPageBits;
+  int old_page_num = mNodePageList.size();
+  for ( int p = page_num; p < old_page_num; ++ p ) {
+    delete [] mNodePageList[p];
+  }
+  mNodePageList.resize(page_num);
+  mNodeNum = new_num;
+  mPatMgr.shrink(new_num);
+
+  // 4. 構造ハッシュと等価候補グループとサポートのリストを作り直す．
+  mHashTable1.clear();
+  mClassMgr.clear();
+  vector<int> support_pool;
+  for ( int id = 1; id < mNodeNum; ++ id ) {
+    FraigNode* node1 = node(id);
+    if ( node1->is_and() ) {
+      mHashTable1.add(node1->fanin_lit(0), node1->fanin_lit(1), id);
+      mClassMgr.add(node1, *this);
+    }
+    if ( node1->mSupportPos >= 0 ) {
+      int pos = node1->mSupportPos;
+      node1->mSupportPos = support_pool.size();
+      support_pool.insert(support_pool.end(),
+			  mSupportPool.begin() + pos,
+			  mSupportPool.begin() + pos + node1->mSupportNum);
+    }
+  }
+  mSupportPool.swap(support_pool);
+
+  // 5. アボートした検査の記録のノード番号を付け替える．
+  std::unordered_set<ymuint64> const_set;
+  for ( auto key: mConstAbortSet ) {
+    int new_id = id_map[key >> 1];
+    if ( new_id != -1 ) {
+      const_set.insert(static_cast<ymuint64>(new_id) * 2 + (key & 1ULL));
+    }
+  }
+  mConstAbortSet.swap(const_set);
+  std::unordered_set<ymuint64> equiv_set;
+  for ( auto key: mEquivAbortSet ) {
+    int new_id1 = id_map[key >> 32];
+    int new_id2 = id_map[(key >> 1) & 0x7FFFFFFFULL];
+    if ( new_id1 != -1 && new_id2 != -1 ) {
+      ymuint64 nid1 = new_id1;
+      ymuint64 nid2 = new_id2;
+      equiv_set.insert((((nid1 << 31) | nid2) << 1) | (key & 1ULL));
+    }
+  }
+  mEquivAbortSet.swap(equiv_set);
+
+  // 6. 削除されたノードの変数が生きている変数より多くなったら
+  //    SAT ソルバを作り直して変数を詰める．
+  //    CNF は必要になった時に読み込み直される．
+  if ( mDeadVarNum > live_var_num ) {
+    rebuild_solver();
+  }
+  //    ポートフォリオのソルバは変数番号の表が古くなるので捨てる．
+  mPortfolio.mWorkerList.clear();
+
+  // 7. ハンドルを新しい番号に付け替える．
+  for ( auto& handle: root_list ) {
+    handle = FraigHandle(id_map[handle.node_id()], handle.inv());
+  }
+}
+
+// @brief SAT スイープを行う．
+// @param[in] root_list 使用中のハンドルのリスト
+void
+FraigMgrImpl::sweep(vector<FraigHandle>& root_list)
+{
+  Timer timer;
+  timer.start();
+
+  // スレッドごとの SAT ソルバ
+  // 検査の間はノードが増えないので変数番号の表の大きさは固定でよい．
+  int nt = mSimEngine.thread_num();
+  vector<unique_ptr<SweepWorker>> worker_list;
+  for ( int tid = 0; tid < nt; ++ tid ) {
+    worker_list.emplace_back(new SweepWorker(*this, mSolverType,
+					     mSweepLimit.mConflict,
+					     mSweepLimit.mPropagation,
+					     mSweepLimit.mTime));
+  }
+
+  if ( mBatchPending && mBatchSimWords > 0 ) {
+    // バッチモードで作ったノードがある時は構築中にほとんどパタンが
+    // 増えていないので，SAT を使う前にまとめてランダムパタンを加えて
+    // クラスを分割しておく．
+    // 後でバッチモードを解除していても行う．
+    Timer timer1;
+    timer1.start();
+    flush_cex();
+    mPatMgr.reserve(mPatUsed + mBatchSimWords);
+    for ( auto node1: mInputNodes ) {
+      mSimEngine.set_random(node1, mPatUsed, mPatUsed + mBatchSimWords, mRandSeed);
+    }
+    commit_word(mBatchSimWords);
+    mSimCount += mBatchSimWords;
+    mSimTime += timer1.get_time();
+  }
+  mBatchPending = false;
+
+  // このスイープの中でアボートした検査は二度と行わない．
+  std::unordered_set<ymuint64> const_abort_set;
+  std::unordered_set<ymuint64> equiv_abort_set;
+
+  vector<SweepQuery> query_list;
+  vector<SweepQuery*> batch;
+  for ( ; ; ) {
+    // 保留中の反例をクラスに反映させてから候補を集める．
+    flush_cex();
+    query_list.clear();
+    collect_sweep_query(query_list, const_abort_set, equiv_abort_set);
+    if ( query_list.empty() ) {
+      break;
+    }
+
+    // 一度に並列に行う検査の数は限っておき，
+    // 前のバッチの反例で区別されたものは調べない．
+    int nq = query_list.size();
+    int bsize = nt * kSweepBatch;
+    for ( int q0 = 0; q0 < nq; q0 += bsize ) {
+      int q1 = std::min(nq, q0 + bsize);
+      batch.clear();
+      for ( int q = q0; q < q1; ++ q ) {
+	if ( is_sweep_candidate(query_list[q]) ) {
+	  batch.push_back(&query_list[q]);
+	}
+      }
+
+      // k 番めの検査は k % n 番めのスレッドが受け持つ．
+      int nb = batch.size();
+      int n = std::min(nt, nb);
+      auto job = [&](int tid) {
+	for ( int k = tid; k < nb; k += n ) {
+	  Timer timer1;
+	  timer1.start();
+	  worker_list[tid]->check(*batch[k]);
+	  batch[k]->mTime = timer1.get_time();
+	}
+      };
+      if ( n > 0 ) {
+	mSimEngine.run(n, job);
+      }
+
+      // 証明された等価性を他のスレッドのソルバにも教えておく．
+      // 検査はトポロジカル順なので上位の検査が簡単になる．
+      for ( int k = 0; k < nb; ++ k ) {
+	if ( batch[k]->mResult != SatBool3::True ) {
+	  continue;
+	}
+	for ( int tid = 0; tid < nt; ++ tid ) {
+	  if ( tid != k % n ) {
+	    worker_list[tid]->add_equiv(*batch[k]);
+	  }
+	}
+      }
+
+      // 結果は検査の順番に反映する．
+      for ( auto query: batch ) {
+	FraigNode* node1 = query->mNode1;
+	FraigNode* node2 = query->mNode2;
+	bool inv = query->mInv;
+	if ( query->mTruthTable ) {
+	  mTruthTableInfo.set_result(query->mResult, query->mTime);
+	}
+	else {
+	  mSweepInfo.set_result(query->mResult, query->mTime);
+	}
+	if ( query->mResult == SatBool3::True ) {
+	  // 同じバッチでマージされていたら何もしない．
+	  // node1 がマージされていた場合は後で rewire() がたどる．
+	  if ( !node2->is_rep() ) {
+	    continue;
+	  }
+	  if ( node1 == nullptr ) {
+	    node2->set_rep(inv ? FraigHandle::one() : FraigHandle::zero());
+	  }
+	  else {
+	    ASSERT_COND( node1->id() < node2->id() );
+	    node2->set_rep(FraigHandle(node1->id(), inv));
+	  }
+	}
+	else if ( query->mResult == SatBool3::False ) {
+	  add_cex(query->mCex);
+	  if ( node1 == nullptr ) {
+	    update_cex_mark(node2);
+	  }
+	}
+	else {
+	  if ( node1 == nullptr ) {
+	    ymuint64 key = static_cast<ymuint64>(node2->id()) * 2 + (inv ? 1 : 0);
+	    const_abort_set.insert(key);
+	  }
+	  else {
+	    ymuint64 nid1 = node1->id();
+	    ymuint64 nid2 = node2->id();
+	    ymuint64 key = (((nid1 << 31) | nid2) << 1) | (inv ? 1 : 0);
+	    equiv_abort_set.insert(key);
+	  }
+	}
+      }
+    }
+  }
+
+  if ( debug ) {
+    cout << "SWEEP: " << mSweepInfo.mTotalCount << " queries, "
+	 << timer.get_time() << " sec." << endl;
+  }
+
+  rewire();
+  garbage_collect(root_list);
+}
+
+// @brief sweep() で調べる検査を集める．
+// @param[out] query_list 検査のリスト
+// @param[in] const_abort_set アボートした定数の検査のキーの集合
+// @param[in] equiv_abort_set アボートした等価検査のキーの集合
+void
+FraigMgrImpl::collect_sweep_query(vector<SweepQuery>& query_list,
+				  const std::unordered_set<ymuint64>& const_abort_set,
+				  const std::unordered_set<ymuint64>& equiv_abort_set)
+{
+  // 0/1 マークを正しくするために全てのノードのパタンを計算しておく．
+  vector<FraigNode*> node_list;
+  for ( int id = 1; id < mNodeNum; ++ id ) {
+    FraigNode* node1 = node(id);
+    if ( node1->is_and() && node1->is_rep() ) {
+      node_list.push_back(node1);
+    }
+  }
+  update_pat(node_list, mPatUsed);
+
+  // 定数の候補
+  for ( auto node1: node_list ) {
+    ymuint64 key = static_cast<ymuint64>(node1->id()) * 2;
+    if ( !node1->check_1mark() && const_abort_set.count(key) == 0 ) {
+      query_list.push_back(SweepQuery(nullptr, node1, false));
+    }
+    if ( !node1->check_0mark() && const_abort_set.count(key + 1) == 0 ) {
+      query_list.push_back(SweepQuery(nullptr, node1, true));
+    }
+  }
+
+  // 等価候補
+  // クラスの先頭のノードは他の要素よりノード番号が小さい．
+  int nc = mClassMgr.nontrivial_num();
+  for ( int i = 0; i < nc; ++ i ) {
+    FraigNode* top = mClassMgr.nontrivial_top(i);
+    if ( !top->is_rep() ) {
+      continue;
+    }
+    for ( int id = mClassMgr.next_id(top->id());
+	  id != -1; id = mClassMgr.next_id(id) ) {
+      FraigNode* node2 = node(id);
+      if ( !node2->is_rep() ) {
+	continue;
+      }
+      bool inv = top->pat_hash_inv() ^ node2->pat_hash_inv();
+      ymuint64 nid1 = top->id();
+      ymuint64 nid2 = id;
+      ymuint64 key = (((nid1 << 31) | nid2) << 1) | (inv ? 1 : 0);
+      if ( equiv_abort_set.count(key) == 0 ) {
+	query_list.push_back(SweepQuery(top, node2, inv));
+      }
+    }
+  }
+
+  // 対象のノード番号の順(トポロジカル順)に並べる．
+  // 同じノードの検査は定数の候補を先にする．
+  std::stable_sort(query_list.begin(), query_list.end(),
+		   [](const SweepQuery& a, const SweepQuery& b) {
+		     return a.mNode2->id() < b.mNode2->id();
+		   });
+}
+
+// @brief sweep() の検査がまだ必要か調べる．
+// @param[in] query 対象の検査
+bool
+FraigMgrImpl::is_sweep_candidate(const SweepQuery& query)
+{
+  FraigNode* node1 = query.mNode1;
+  FraigNode* node2 = query.mNode2;
+  if ( !node2->is_rep() ) {
+    return false;
+  }
+  if ( node1 == nullptr ) {
+    update_cex_mark(node2);
+    return query.mInv ? !node2->check_0mark() : !node2->check_1mark();
+  }
+  if ( !node1->is_rep() || node1->class_id() != node2->class_id() ) {
+    return false;
+  }
+  return compare_cex(node1, node2, query.mInv);
+}
+
+// @brief マージされたノードのファンアウトを代表ノードにつなぎ替える．
+void
+FraigMgrImpl::rewire()
+{
+  // 代表ノードは常にノード番号の小さいノードか定数なので
+  // ノード番号の順に処理すればファンインは処理済みになっている．
+  for ( int id = 1; id < mNodeNum; ++ id ) {
+    FraigNode* node1 = node(id);
+    if ( !node1->is_and() || !node1->is_rep() ) {
+      continue;
+    }
+    FraigHandle handle1 = resolve_rep(fanin_handle(node1, 0));
+    FraigHandle handle2 = resolve_rep(fanin_handle(node1, 1));
+    if ( handle1 == fanin_handle(node1, 0) &&
+	 handle2 == fanin_handle(node1, 1) ) {
+      continue;
+    }
+
+    // make_and() と同様の簡単化を行う．
+    if ( handle1.is_zero() || handle2.is_zero() ) {
+      node1->set_rep(FraigHandle::zero());
+    }
+    else if ( handle1.is_one() ) {
+      node1->set_rep(handle2);
+    }
+    else if ( handle2.is_one() ) {
+      node1->set_rep(handle1);
+    }
+    else if ( handle1 == handle2 ) {
+      node1->set_rep(handle1);
+    }
+    else if ( handle1.node_id() == handle2.node_id() ) {
+      node1->set_rep(FraigHandle::zero());
+    }
+    else {
+      if ( handle1.node_id() < handle2.node_id() ) {
+	std::swap(handle1, handle2);
+      }
+      node1->set_fanin(handle1, handle2);
+
+      // 同じ構造のノードがあればマージする．
+      // 番号の大きい方を小さい方にマージする．
+      ymuint32 lit1 = handle1.lit();
+      ymuint32 lit2 = handle2.lit();
+      int id1 = mHashTable1.find(lit1, lit2);
+      if ( id1 == -1 ) {
+	mHashTable1.add(lit1, lit2, id);
+      }
+      else if ( id1 != id ) {
+	FraigHandle rep = resolve_rep(FraigHandle(id1, false));
+	if ( rep.is_const() || rep.node_id() < id ) {
+	  node1->set_rep(rep);
+	}
+	else if ( rep.node_id() > id ) {
+	  node(rep.node_id())->set_rep(FraigHandle(id, rep.inv()));
+	}
+      }
+    }
+  }
+
+  // 代表ノードを直接指すようにする．
+  // つなぎ替えたノードのサポートは小さくなっている可能性があるので求め直す．
+  for ( int id = 1; id < mNodeNum; ++ id ) {
+    FraigNode* node1 = node(id);
+    if ( !node1->is_rep() ) {
+      node1->set_rep(resolve_rep(FraigHandle(id, false)));
+    }
+    else if ( node1->is_and() ) {
+      calc_support(node1);
+    }
+  }
+}
+
+// @brief 代表ノードをたどったハンドルを返す．
+// @param[in] handle 対象のハンドル
+FraigHandle
+FraigMgrImpl::resolve_rep(FraigHandle handle) const
+{
+  while ( !handle.is_const() ) {
+    FraigNode* node1 = node(handle.node_id());
+    if ( node1->is_rep() ) {
+      break;
+    }
+    FraigHandle rep = node1->rep_handle();
+    handle = handle.inv() ? ~rep : rep;
+  }
+  return handle;
+}
+
+// @brief ノードのファンインコーンの CNF 式を読み込む．
+// @param[in] node 対象のノード
+// @param[in] freeze node の変数を凍結する時 true にする．
+void
+FraigMgrImpl::load_cnf(FraigNode* node,
+		       bool freeze)
+{
+  if ( node->is_loaded() ) {
+    if ( freeze ) {
+      freeze_node(node);
+    }
+    return;
+  }
+
+  // 読み込まれていないノードに変数を割り当てる．
+  // 節はファンインの変数がそろってから作る．
+  vector<FraigNode*> node_list;
+  vector<FraigNode*> node_stack{node};
+  while ( !node_stack.empty() ) {
+    FraigNode* node1 = node_stack.back();
+    node_stack.pop_back();
+    if ( node1->is_loaded() ) {
+      continue;
+    }
+    node1->mVarId = mSolver->new_variable();
+    node1->set_loaded();
+    if ( freeze || node1 != node ) {
+      freeze_node(node1);
+    }
+    node_list.push_back(node1);
+    if ( node1->is_and() ) {
+      for ( int pos: { 0, 1 } ) {
+	FraigNode* inode = fanin_node(node1, pos);
+	if ( !inode->is_loaded() ) {
+	  node_stack.push_back(inode);
+	}
+      }
+    }
+  }
+
+  for ( auto node1: node_list ) {
+    if ( node1->is_and() ) {
+      make_cnf(node1);
+    }
+  }
+}
+
+// @brief ノードの変数を凍結する．
+// @param[in] node 対象のノード
+void
+FraigMgrImpl::freeze_node(FraigNode* node)
+{
+  if ( !node->is_frozen() ) {
+    mSolver->freeze_literal(SatLiteral(node->varid()));
+    node->set_frozen();
+    ++ mFrozenNum;
+  }
+}
+
 // @brief ノードの入出力の関係を表す CNF 式を作る．
 void
 FraigMgrImpl::make_cnf(FraigNode* node)
 {
-  FraigHandle handle1 = node->fanin0_handle();
-  FraigHandle handle2 = node->fanin1_handle();
   SatLiteral lito(node->varid(), false);
-  SatLiteral lit1 = handle1.literal();
-  SatLiteral lit2 = handle2.literal();
-  mSolver.add_clause(~lit1, ~lit2, lito);
-  mSolver.add_clause( lit1, ~lito);
-  mSolver.add_clause( lit2, ~lito);
+  SatLiteral lit1(fanin_node(node, 0)->varid(), node->fanin0_inv());
+  SatLiteral lit2(fanin_node(node, 1)->varid(), node->fanin1_inv());
+  mSolver->add_clause(~lit1, ~lit2, lito);
+  mSolver->add_clause( lit1, ~lito);
+  mSolver->add_clause( lit2, ~lito);
 }
 
 // @brief 0縮退検査を行う．
@@ -193,30 +1014,32 @@ FraigMgrImpl::verify_const(FraigNode* node,
   SatBool3 stat = SatBool3::False;
   if ( !node->check_1mark() ) {
     // 定数0の可能性があるか調べる．
-    stat = check_const(node, false);
+    stat = check_const(node, false, true);
     if ( stat == SatBool3::True ) {
       // 定数0と等価だった．
-      node->set_rep(nullptr, false);
+      node->set_rep(FraigHandle::zero());
       ans = FraigHandle::zero();
     }
     else if ( stat == SatBool3::False ) {
       // 反例をパタンに加えておく．
-      add_pat(node);
+      add_cex();
+      update_cex_mark(node);
 
       ASSERT_COND(node->check_1mark() );
     }
   }
   if ( !node->check_0mark() ) {
     // 定数1の可能性があるか調べる．
-    stat = check_const(node, true);
+    stat = check_const(node, true, true);
     if ( stat == SatBool3::True ) {
       // 定数1と等価だった．
-      node->set_rep(nullptr, true);
+      node->set_rep(FraigHandle::one());
       ans = FraigHandle::one();
     }
     else if ( stat == SatBool3::False ) {
       // 反例をパタンに加えておく．
-      add_pat(node);
+      add_cex();
+      update_cex_mark(node);
 
       ASSERT_COND(node->check_0mark() );
     }
@@ -225,7 +1048,15 @@ FraigMgrImpl::verify_const(FraigNode* node,
   return stat;
 }
 
-// @brief パタンハッシュで同値と判定されたノードを比較する．
+// @brief 同じクラスに属するノードを比較する．
+// @param[in] node1 クラスに属しているノード
+// @param[in] node2 対象のノード
+// @param[in] inv false で同相，true で逆相を表す．
+// @param[out] retry クラスが分割されたので探索をやり直す時 true を返す．
+// @return 等価だった時 true を返す．
+//
+// 確定したパタンはクラスの性質から等しいので
+// 保留中の反例のみを比べる．
 bool
 FraigMgrImpl::compare_node(FraigNode* node1,
 			   FraigNode* node2,
@@ -233,67 +1064,280 @@ FraigMgrImpl::compare_node(FraigNode* node1,
 			   bool& retry)
 {
   retry = false;
-  if ( compare_pat(node1, node2, inv) ) {
+  if ( compare_cex(node1, node2, inv) ) {
+    if ( mSimStreak < mLoopLimit ) {
+      // SAT を使う前にランダムシミュレーションで候補を絞る．
+      // ワードが追加された時はクラスが変わっている可能性があるのでやり直す．
+      int old_used = mPatUsed;
+      random_sim(node1, node2, inv);
+      if ( mPatUsed > old_used ) {
+	retry = true;
+	return false;
+      }
+    }
+
     // node1 と node2 が等価かどうか調べる．
-    SatBool3 stat = check_equiv(node1, node2, inv);
+    SatBool3 stat = check_equiv(node1, node2, inv, true);
     if ( stat == SatBool3::True ) {
       // 等価なノードが見つかった．
-      node1->set_rep(node2, inv);
+      node2->set_rep(FraigHandle(node1->id(), inv));
       return true;
     }
     else if ( stat == SatBool3::False ) {
-      // 反例をパタンに加えて再ハッシュする．
-      add_pat(node2);
+      // 反例を保留中のワードに加える．
+      // ワードが一杯になってクラスが分割された場合にはやり直す．
+      retry = add_cex();
 
-      ASSERT_COND( !compare_pat(node1, node2, inv) );
-      retry = true;
+      ASSERT_COND( retry || !compare_cex(node1, node2, inv) );
       return false;
     }
   }
   return false;
 }
 
-// @breif 直前の SAT の反例を加えて再ハッシュする．
+// @brief 直前の SAT の反例を保留中のワードに加える．
+// @return ワードが一杯になってクラスを分割した時に true を返す．
+bool
+FraigMgrImpl::add_cex()
+{
+  if ( mLastCexValid ) {
+    // ポートフォリオのソルバが見つけた反例
+    return add_cex(mLastCex);
+  }
+
+  // CNF が読み込まれていない入力は問題に関係しないので 0 とする．
+  const SatModel& model = mSolver->model();
+  vector<bool> cex(mInputNodes.size(), false);
+  for ( auto node1: mInputNodes ) {
+    if ( node1->is_loaded() && model[node1->varid()] == SatBool3::True ) {
+      cex[node1->input_id()] = true;
+    }
+  }
+  return add_cex(cex);
+}
+
+// @brief 反例を保留中のワードに加える．
+// @param[in] cex 反例の入力値(入力番号がインデックス)
+// @return ワードが一杯になってクラスを分割した時に true を返す．
+bool
+FraigMgrImpl::add_cex(const vector<bool>& cex)
+{
+  if ( mCexNum == 0 ) {
+    // 足りなければブロックを追加する．
+    mPatMgr.reserve(mPatUsed + 1);
+  }
+
+  // 反例を mCexNum 番目のビットに書き込む．
+  ymuint64 bit = 1ULL << mCexNum;
+  for ( auto node1: mInputNodes ) {
+    ymuint64& pat = mPatMgr.word(node1->id(), mPatUsed);
+    if ( mCexNum == 0 ) {
+      pat = 0ULL;
+    }
+    if ( cex[node1->input_id()] ) {
+      pat |= bit;
+    }
+  }
+  ++ mCexNum;
+  ++ mCexStamp;
+
+  if ( mCexNum == 64 ) {
+    flush_cex();
+    return true;
+  }
+  return false;
+}
+
+// @brief 保留中の反例のワードを全ノードでシミュレーションしてクラスを分割する．
 void
-FraigMgrImpl::add_pat(FraigNode* node)
+FraigMgrImpl::flush_cex()
 {
-  if ( mPatSize <= mPatUsed ) {
-    resize_pat(mPatSize * 2);
+  if ( mCexNum == 0 ) {
+    return;
   }
-  mHashTable2.clear();
 
-  // 反例をパタンに加える．
-  const SatModel& model = mSolver.model();
+  // 空いているビットは反例をランダムに少し変えたもので埋める．
   vector<ymuint64> tmp(1);
-  int nn = node_num();
   std::uniform_int_distribution<int> rd100(0, 99);
-  for ( int i = 0; i < nn; ++ i ) {
-    FraigNode* node1 = mAllNodes[i];
-    if ( node1->is_input() ) {
-      ymuint64 pat = 0U;
-      if ( model[node1->varid()] == SatBool3::True ) {
-	pat = ~0U;
+  for ( auto node1: mInputNodes ) {
+    ymuint64 pat = mPatMgr.word(node1->id(), mPatUsed);
+    for ( int b = mCexNum; b < 64; ++ b ) {
+      ymuint64 val = (pat >> (b % mCexNum)) & 1ULL;
+      if ( rd100(mRandGen) <= 3 ) {
+	val ^= 1ULL;
       }
-      else {
-	pat = 0U;
-      }
-      for ( int b = 1; b < 32; ++ b ) {
-	if ( rd100(mRandGen) <= 3 ) {
-	  pat ^= (1U << b);
-	}
-      }
-      tmp[0] = pat;
-      node1->set_pat(mPatUsed, mPatUsed + 1, tmp);
+      pat |= (val << b);
+    }
+    tmp[0] = pat;
+    set_pat(node1, mPatUsed, mPatUsed + 1, tmp);
+  }
+
+  mCexNum = 0;
+  ++ mCexStamp;
+  if ( commit_word() ) {
+    // クラスが分割されたのでランダムシミュレーションをやり直す．
+    mSimStreak = 0;
+  }
+}
+
+// @brief ランダムパタンでクラスを分割する．
+// @param[in] node1, node2 等価候補のノード対
+// @param[in] inv false で同相，true で逆相を表す．
+// @return node1 と node2 が区別された時 true を返す．
+bool
+FraigMgrImpl::random_sim(FraigNode* node1,
+			 FraigNode* node2,
+			 bool inv)
+{
+  Timer timer;
+  timer.start();
+
+  // 保留中の反例があれば先に確定させておく．
+  flush_cex();
+
+  bool found = false;
+  while ( mSimStreak < mLoopLimit ) {
+    // 入力に乱数を1ワード加えてクラスを分割する．
+    mPatMgr.reserve(mPatUsed + 1);
+    for ( auto node: mInputNodes ) {
+      mSimEngine.set_random(node, mPatUsed, mPatUsed + 1, mRandSeed);
+    }
+    bool changed = commit_word();
+    ++ mSimCount;
+
+    if ( !compare_pat(node1, node2, inv, mPatUsed - 1, mPatUsed) ) {
+      found = true;
+      changed = true;
+    }
+    if ( changed ) {
+      mSimStreak = 0;
     }
     else {
-      node1->calc_pat(mPatUsed, mPatUsed + 1);
+      ++ mSimStreak;
+    }
+    if ( found ) {
+      break;
+    }
+  }
+
+  timer.stop();
+  mSimTime += timer.get_time();
+
+  return found;
+}
+
+// @brief 入力にセットされた mPatUsed 番目からのワードを確定させてクラスを分割する．
+// @param[in] num ワード数
+// @return クラスが分割された時 true を返す．
+bool
+FraigMgrImpl::commit_word(int num)
+{
+  // 要素数が2以上のクラスに属しているノードのファンインコーンのみ
+  // 新しいワードを計算する．
+  // それ以外のノードは参照された時点で計算する．
+  vector<FraigNode*> root_list;
+  int nc = mClassMgr.nontrivial_num();
+  for ( int i = 0; i < nc; ++ i ) {
+    for ( int id = mClassMgr.nontrivial_top(i)->id();
+	  id != -1; id = mClassMgr.next_id(id) ) {
+      root_list.push_back(node(id));
     }
+  }
+  update_pat(root_list, mPatUsed + num);
+  mPatUsed += num;
+
+  // 追加したワードでクラスを分割する．
+  int old_num = mClassMgr.class_num();
+  mClassMgr.refine(*this, mPatUsed - num, mPatUsed);
+  return mClassMgr.class_num() > old_num;
+}
 
-    if ( node1 != node ) {
-      mHashTable2.add(node1);
+// @brief 保留中の反例のワードをノードのファンインコーンについて計算する．
+// @param[in] node 対象のノード
+//
+// 計算結果は mPatUsed 番目のワードに格納される．
+void
+FraigMgrImpl::eval_cex(FraigNode* node)
+{
+  if ( mCexNum == 0 ) {
+    return;
+  }
+
+  vector<FraigNode*> node_stack{node};
+  while ( !node_stack.empty() ) {
+    FraigNode* node1 = node_stack.back();
+    if ( node1->is_input() || node1->mCexStamp == mCexStamp ) {
+      node_stack.pop_back();
+      continue;
+    }
+    FraigNode* inode0 = fanin_node(node1, 0);
+    FraigNode* inode1 = fanin_node(node1, 1);
+    bool ready = true;
+    if ( inode0->is_and() && inode0->mCexStamp != mCexStamp ) {
+      node_stack.push_back(inode0);
+      ready = false;
+    }
+    if ( inode1->is_and() && inode1->mCexStamp != mCexStamp ) {
+      node_stack.push_back(inode1);
+      ready = false;
+    }
+    if ( ready ) {
+      ymuint64 pat0 = mPatMgr.word(inode0->id(), mPatUsed);
+      ymuint64 pat1 = mPatMgr.word(inode1->id(), mPatUsed);
+      if ( node1->fanin0_inv() ) {
+	pat0 = ~pat0;
+      }
+      if ( node1->fanin1_inv() ) {
+	pat1 = ~pat1;
+      }
+      mPatMgr.word(node1->id(), mPatUsed) = pat0 & pat1;
+      node1->mCexStamp = mCexStamp;
+      node_stack.pop_back();
     }
   }
-  ++ mPatUsed;
+}
+
+// @brief 保留中の反例の上で2つのノードの値が等しいか調べる．
+bool
+FraigMgrImpl::compare_cex(FraigNode* node1,
+			  FraigNode* node2,
+			  bool inv)
+{
+  if ( mCexNum == 0 ) {
+    return true;
+  }
+
+  eval_cex(node1);
+  eval_cex(node2);
+  ymuint64 pat1 = mPatMgr.word(node1->id(), mPatUsed);
+  ymuint64 pat2 = mPatMgr.word(node2->id(), mPatUsed);
+  if ( inv ) {
+    pat2 = ~pat2;
+  }
+  return ((pat1 ^ pat2) & cex_mask()) == 0ULL;
+}
+
+// @brief 保留中の反例の値から 0/1 マークをつける．
+void
+FraigMgrImpl::update_cex_mark(FraigNode* node)
+{
+  if ( mCexNum == 0 ) {
+    // 反例はすでに確定したワードに取り込まれている．
+    // node がクラスに属していなければそのワードは未計算なので
+    // ここで計算して 0/1 マークを更新する．
+    update_pat(node, mPatUsed);
+    return;
+  }
+
+  eval_cex(node);
+  ymuint64 pat = mPatMgr.word(node->id(), mPatUsed);
+  ymuint64 mask = cex_mask();
+  if ( (pat & mask) != 0ULL ) {
+    node->set_1mark();
+  }
+  if ( (~pat & mask) != 0ULL ) {
+    node->set_0mark();
+  }
 }
 
 // @brief 2つのハンドルが等価かどうか調べる．
@@ -301,19 +1345,30 @@ SatBool3
 FraigMgrImpl::check_equiv(FraigHandle aig1,
 			  FraigHandle aig2)
 {
+  // マージされたノードは代表ノードに置き換える．
+  // 作り直したソルバに代表でないノードの CNF を読み込まないようにするため
+  if ( !aig1.is_const() ) {
+    FraigHandle rep1 = node(aig1.node_id())->rep_handle();
+    aig1 = aig1.inv() ? ~rep1 : rep1;
+  }
+  if ( !aig2.is_const() ) {
+    FraigHandle rep2 = node(aig2.node_id())->rep_handle();
+    aig2 = aig2.inv() ? ~rep2 : rep2;
+  }
+
   if ( aig1 == aig2 ) {
     // もっとも簡単なパタン
     return SatBool3::True;
   }
 
-  FraigNode* node1 = aig1.node();
-  FraigNode* node2 = aig2.node();
-
-  if ( node1 == node2 ) {
+  if ( aig1.node_id() == aig2.node_id() ) {
     // ということは逆極性なので絶対に等価ではない．
     return SatBool3::False;
   }
 
+  // 定数の場合は予約されたノード 0 になるが参照はされない．
+  FraigNode* node1 = node(aig1.node_id());
+  FraigNode* node2 = node(aig2.node_id());
   bool inv1 = aig1.inv();
   bool inv2 = aig2.inv();
 
@@ -370,74 +1425,364 @@ FraigMgrImpl::set_loop_limit(int val)
   mLoopLimit = val;
 }
 
-// @brief ノードのシミュレーションパタン用配列を確保する．
+// @brief シミュレーションと sweep() に用いるスレッド数を設定する．
+void
+FraigMgrImpl::set_thread_num(int num)
+{
+  // ポートフォリオのソルバは同じスレッドプールで動かす．
+  int n = mPortfolio.mTypeList.size();
+  mSimEngine.set_thread_num(std::max(num, n));
+}
+
+// @brief check_const で用いる SAT の予算を設定する．
+void
+FraigMgrImpl::set_check_const_limit(SizeType conflict_limit,
+				    SizeType propagation_limit,
+				    int time_limit)
+{
+  mCheckConstLimit = SatLimit{conflict_limit, propagation_limit, time_limit};
+}
+
+// @brief check_equiv で用いる SAT の予算を設定する．
+void
+FraigMgrImpl::set_check_equiv_limit(SizeType conflict_limit,
+				    SizeType propagation_limit,
+				    int time_limit)
+{
+  mCheckEquivLimit = SatLimit{conflict_limit, propagation_limit, time_limit};
+}
+
+// @brief SAT ソルバを作り直す条件を設定する．
+void
+FraigMgrImpl::set_rebuild_limit(SizeType clause_limit,
+				SizeType var_limit,
+				double time_ratio)
+{
+  mRebuildInfo.mClauseLimit = clause_limit;
+  mRebuildInfo.mVarLimit = var_limit;
+  mRebuildInfo.mTimeRatio = time_ratio;
+}
+
+// @brief ポートフォリオに用いる SAT ソルバを設定する．
+void
+FraigMgrImpl::set_portfolio(const vector<SatSolverType>& type_list,
+			    SizeType conflict_limit,
+			    SizeType propagation_limit,
+			    int time_limit)
+{
+  int n = type_list.size();
+  mPortfolio.mTypeList = type_list;
+  mPortfolio.mLimit = SatLimit{conflict_limit, propagation_limit, time_limit};
+  mPortfolio.mWinCount.clear();
+  mPortfolio.mWinCount.resize(n, 0);
+  mPortfolio.mWinTime.clear();
+  mPortfolio.mWinTime.resize(n, 0.0);
+  mPortfolio.mWorkerList.clear();
+  if ( mSimEngine.thread_num() < n ) {
+    mSimEngine.set_thread_num(n);
+  }
+}
+
+// @brief sweep() で用いる SAT の予算を設定する．
+void
+FraigMgrImpl::set_sweep_limit(SizeType conflict_limit,
+			      SizeType propagation_limit,
+			      int time_limit)
+{
+  mSweepLimit = SatLimit{conflict_limit, propagation_limit, time_limit};
+}
+
+// @brief 一度アボートした検査を再び行わないかどうかを設定する．
+void
+FraigMgrImpl::set_skip_aborted(bool flag)
+{
+  mSkipAborted = flag;
+}
+
+// @brief 等価検査をミタ回路を用いた1回の SAT で行うかどうかを設定する．
+void
+FraigMgrImpl::set_miter_check(bool flag)
+{
+  mMiterCheck = flag;
+}
+
+// @brief 構築中の検査を sweep() にまとめるかどうかを設定する．
+void
+FraigMgrImpl::set_batch_mode(bool flag,
+			     int sim_words)
+{
+  mBatchMode = flag;
+  mBatchSimWords = sim_words;
+}
+
+// @brief パタンをセットする．
+// @param[in] node 対象のノード
+// @param[in] start 開始位置
+// @param[in] end 終了位置
+// @param[in] pat パタンのベクタ
+void
+FraigMgrImpl::set_pat(FraigNode* node,
+		      int start,
+		      int end,
+		      const vector<ymuint64>& pat)
+{
+  const int kBlockSize = PatMgr::kBlockSize;
+  int id = node->id();
+  for ( int b = start / kBlockSize; b * kBlockSize < end; ++ b ) {
+    int offset = b * kBlockSize;
+    int s = std::max(start, offset);
+    int e = std::min(end, offset + kBlockSize);
+    ymuint64* dst = mPatMgr.block(id, b) + (s - offset);
+    for ( int i = s; i < e; ++ i ) {
+      dst[i - s] = pat[i - start];
+    }
+    node->calc_hash(s, e, dst);
+  }
+  node->mSimEnd = end;
+}
+
+// @brief ノードのパタンを end ワードめの手前まで計算済みにする．
+// @param[in] node 対象のノード
+// @param[in] end 終了位置
 void
-FraigMgrImpl::init_pat(FraigNode* node)
+FraigMgrImpl::update_pat(FraigNode* node,
+			 int end)
 {
-  ASSERT_COND(node->mPat == nullptr );
-  node->mPat = new ymuint64[mPatSize];
+  if ( node->sim_end() < end ) {
+    update_pat(vector<FraigNode*>{node}, end);
+  }
 }
 
-// @brief 全ノードのシミュレーションパタン用配列を拡大する．
+// @brief 複数のノードのパタンを end ワードめの手前まで計算済みにする．
+// @param[in] root_list 対象のノードのリスト
+// @param[in] end 終了位置
 void
-FraigMgrImpl::resize_pat(int size)
+FraigMgrImpl::update_pat(const vector<FraigNode*>& root_list,
+			 int end)
 {
-  int n = mAllNodes.size();
-  for ( int i = 0; i < n; ++ i ) {
-    FraigNode* node = mAllNodes[i];
-    ymuint64* old_array = node->mPat;
-    node->mPat = new ymuint64[size];
-    for ( int j = 0; j < mPatUsed; ++ j ) {
-      node->mPat[j] = old_array[j];
+  // ファンインコーン中の未計算のノードを集める．
+  // 入力ノードは常に計算済みになっている．
+  vector<FraigNode*> node_list;
+  vector<FraigNode*> node_stack;
+  for ( auto node: root_list ) {
+    if ( node->sim_end() < end && !node->check_tmark() ) {
+      node->set_tmark();
+      node_stack.push_back(node);
+    }
+  }
+  while ( !node_stack.empty() ) {
+    FraigNode* node = node_stack.back();
+    node_stack.pop_back();
+    node_list.push_back(node);
+    for ( int pos: { 0, 1 } ) {
+      FraigNode* inode = fanin_node(node, pos);
+      if ( inode->sim_end() < end && !inode->check_tmark() ) {
+	inode->set_tmark();
+	node_stack.push_back(inode);
+      }
     }
-    delete [] old_array;
   }
-  mPatSize = size;
+
+  // ノード番号の順に計算すればファンインは先に計算される．
+  sort(node_list.begin(), node_list.end(),
+       [](FraigNode* a, FraigNode* b) { return a->id() < b->id(); });
+  mSimEngine.calc_pat(node_list, end);
+  for ( auto node: node_list ) {
+    node->clear_tmark();
+  }
 }
 
 // @brief シミュレーションパタンが等しいか調べる．
+// @param[in] node1, node2 対象のノード
+// @param[in] inv false で同相，true で逆相を表す．
+// @param[in] start 開始位置
+// @param[in] end 終了位置
 bool
 FraigMgrImpl::compare_pat(FraigNode* node1,
 			  FraigNode* node2,
-			  bool inv)
+			  bool inv,
+			  int start,
+			  int end)
 {
-  ymuint64* src1 = node1->mPat;
-  ymuint64* src2 = node2->mPat;
-  ymuint64* end = src1 + mPatUsed;
-  if ( inv ) {
-    for ( ; src1 != end; ++ src1, ++ src2) {
-      if ( *src1 != ~*src2 ) {
-	return false;
-      }
-    }
+  update_pat(node1, end);
+  update_pat(node2, end);
+
+  // ハッシュ値は 0 ワードめからのパタン全体から計算されているので
+  // 極性の正規化が inv と一致していればハッシュ値で区別できる．
+  if ( node1->sim_end() == end && node2->sim_end() == end &&
+       (node1->pat_hash_inv() ^ node2->pat_hash_inv()) == inv &&
+       node1->pat_hash() != node2->pat_hash() ) {
+    return false;
   }
-  else {
-    for ( ; src1 != end; ++ src1, ++ src2) {
-      if ( *src1 != *src2 ) {
-	return false;
-      }
+
+  const int kBlockSize = PatMgr::kBlockSize;
+  int id1 = node1->id();
+  int id2 = node2->id();
+  for ( int b = start / kBlockSize; b * kBlockSize < end; ++ b ) {
+    int offset = b * kBlockSize;
+    int s = std::max(start, offset);
+    int e = std::min(end, offset + kBlockSize);
+    const ymuint64* src1 = mPatMgr.block(id1, b) + (s - offset);
+    const ymuint64* src2 = mPatMgr.block(id2, b) + (s - offset);
+    if ( !SimKernel::equal_pat(src1, src2, e - s, inv) ) {
+      return false;
     }
   }
   return true;
 }
 
+// @brief クラスの索引に用いるキーを返す．
+// @param[in] node 対象のノード
+// @param[in] key start ワードめの手前までのパタンから計算したキー
+// @param[in] start 開始位置
+// @param[in] end 終了位置
+//
+// 0 ワードめから end - 1 ワードめまでのパタンから計算したキーを返す．
+// キーは1ワードずつ順に畳み込むので途中のキーから続けて計算できる．
+// start が 0 の時は key に 0 を与える．
+SizeType
+FraigMgrImpl::class_key(FraigNode* node,
+			SizeType key,
+			int start,
+			int end)
+{
+  update_pat(node, end);
+
+  // 極性は 0 ワードめの最下位ビットが 1 になるように正規化する．
+  const int kBlockSize = PatMgr::kBlockSize;
+  ymuint64 mask = node->pat_hash_inv() ? 0ULL : ~0ULL;
+  ymuint64 key1 = key;
+  for ( int b = start / kBlockSize; b * kBlockSize < end; ++ b ) {
+    int offset = b * kBlockSize;
+    int s = std::max(start, offset);
+    int e = std::min(end, offset + kBlockSize);
+    const ymuint64* src = mPatMgr.block(node->id(), b) + (s - offset);
+    for ( int i = s; i < e; ++ i, ++ src ) {
+      key1 = (key1 ^ (*src ^ mask)) * 0x9e3779b97f4a7c15ULL;
+      key1 ^= (key1 >> 32);
+    }
+  }
+  return key1;
+}
+
+// @brief 最初にクラスのキーの計算に用いるワード数を返す．
+int
+FraigMgrImpl::class_key_size() const
+{
+  return std::min(mPatInit, kKeySize);
+}
+
 // @brief 新しいノードを生成する．
 FraigNode*
 FraigMgrImpl::new_node()
 {
-  FraigNode* node = new FraigNode();
-  node->mVarId = mSolver.new_variable();
-  ASSERT_COND(node->mVarId.varid() == mAllNodes.size() );
-  mSolver.freeze_literal(SatLiteral(node->mVarId));
-  init_pat(node);
-  mAllNodes.push_back(node);
+  int id = mPatMgr.add_node();
+  ASSERT_COND( id == mNodeNum );
+  if ( (id & kPageMask) == 0 ) {
+    mNodePageList.push_back(new FraigNode[kPageSize]);
+  }
+  ++ mNodeNum;
+  FraigNode* node = mNodePageList[id >> kPageBits] + (id & kPageMask);
+  // ガーベージコレクションの後は使用済みの領域を再利用する．
+  *node = FraigNode();
+  node->mId = id;
+  node->mRepLit = id * 2;
   return node;
 }
 
+// @brief SAT ソルバを作り直す．
+void
+FraigMgrImpl::rebuild_solver()
+{
+  Timer timer;
+  timer.start();
+
+  mSolver.reset(new SatSolver(mSolverType));
+  for ( int id = 1; id < mNodeNum; ++ id ) {
+    node(id)->clear_loaded();
+  }
+  mActLitList.clear();
+  mDeadVarNum = 0;
+  mFrozenNum = 0;
+
+  // 作り直す前の平均検査時間を覚えておく．
+  // 一度も検査していない場合は前の値をそのまま使う．
+  RebuildInfo& info = mRebuildInfo;
+  if ( info.mBaseAve >= 0.0 ) {
+    info.mPrevAve = info.mLastAve;
+  }
+  else if ( info.mWindowNum > 0 ) {
+    info.mPrevAve = info.mWindowTime / info.mWindowNum;
+  }
+  info.mQueryNum = 0;
+  info.mWindowNum = 0;
+  info.mWindowTime = 0.0;
+  info.mBaseAve = -1.0;
+  ++ info.mCount;
+  info.mTime += timer.get_time();
+}
+
+// @brief 必要ならば SAT ソルバを作り直す．
+void
+FraigMgrImpl::check_rebuild()
+{
+  const RebuildInfo& info = mRebuildInfo;
+
+  // 代表ノードの CNF を読み込み直すだけで上限を超えることもあるので
+  // 作り直してから1区間分の検査を行うまでは判定しない．
+  if ( info.mQueryNum < kRebuildWindow ) {
+    return;
+  }
+
+  bool rebuild = false;
+  if ( info.mClauseLimit > 0 && mSolver->clause_num() > info.mClauseLimit ) {
+    rebuild = true;
+  }
+  else if ( info.mVarLimit > 0 && mSolver->variable_num() > info.mVarLimit ) {
+    rebuild = true;
+  }
+  else if ( info.mTimeRatio > 0.0 && info.mBaseAve > 0.0 &&
+	    info.mLastAve > info.mBaseAve * info.mTimeRatio ) {
+    rebuild = true;
+  }
+  if ( rebuild ) {
+    if ( debug ) {
+      cout << "REBUILD SOLVER: "
+	   << mSolver->variable_num() << " vars, "
+	   << mSolver->clause_num() << " clauses" << endl;
+    }
+    rebuild_solver();
+  }
+}
+
+// @brief 1回の検査の時間を記録する．
+void
+FraigMgrImpl::record_query(double t)
+{
+  RebuildInfo& info = mRebuildInfo;
+  ++ info.mQueryNum;
+  ++ info.mWindowNum;
+  info.mWindowTime += t;
+  if ( info.mPrevAve >= 0.0 ) {
+    // 作り直さなかった場合は直前の平均時間がかかったとみなす．
+    info.mSavedTime += info.mPrevAve - t;
+  }
+  if ( info.mWindowNum == kRebuildWindow ) {
+    double ave = info.mWindowTime / info.mWindowNum;
+    if ( info.mBaseAve < 0.0 ) {
+      info.mBaseAve = ave;
+    }
+    info.mLastAve = ave;
+    info.mWindowNum = 0;
+    info.mWindowTime = 0.0;
+  }
+}
+
 // node が定数かどうか調べる．
 SatBool3
 FraigMgrImpl::check_const(FraigNode* node,
-			  bool inv)
+			  bool inv,
+			  bool merge)
 {
   if ( debug ) {
     cout << "CHECK CONST";
@@ -447,24 +1792,49 @@ FraigMgrImpl::check_const(FraigNode* node,
     else {
       cout << "0";
     }
-    cout << " " << setw(6) << node->varid()
+    cout << " " << setw(6) << node->id()
 	 << "       ";
     cout.flush();
   }
 
+  // 真理値表の検査はアボートしないので SAT より先に行う．
+  SatBool3 tt_stat = try_truth_table(nullptr, node, inv);
+  if ( tt_stat != SatBool3::X ) {
+    return tt_stat;
+  }
+
+  ymuint64 key = static_cast<ymuint64>(node->id()) * 2 + (inv ? 1 : 0);
+  if ( mSkipAborted && mConstAbortSet.count(key) > 0 ) {
+    // 以前にアボートしたので調べない．
+    if ( debug ) {
+      cout << "\tSKIPPED" << endl;
+    }
+    ++ mCheckConstInfo.mSkipCount;
+    return SatBool3::X;
+  }
+
+  check_rebuild();
+  mLastCexValid = false;
+
   Timer timer;
   timer.start();
 
+  // merge が true の時は検査が終わるまで凍結しない．
+  // 検査中の SAT では仮定に含まれるので除去されることはない．
+  load_cnf(node, !merge);
   SatLiteral lit{node->varid(), inv};
 
   // この関数の戻り値
   SatBool3 code = SatBool3::X;
 
   // lit = 1 が成り立つか調べる
-  SatBool3 stat = check_condition(lit);
+  SatBool3 stat = check_condition(lit, mCheckConstLimit);
+  if ( stat == SatBool3::X && !mPortfolio.mTypeList.empty() ) {
+    stat = race(nullptr, node, inv);
+  }
   if ( stat == SatBool3::False ) {
     // 成り立たないということは lit = 0
-    mSolver.add_clause(~lit);
+    mSolver->add_clause(~lit);
     if ( debug ) {
       cout << "\tSUCCEED" << endl;
     }
@@ -482,8 +1852,14 @@ FraigMgrImpl::check_const(FraigNode* node,
     if ( debug ) {
       cout << "\tABORTED" << endl;
     }
+    mConstAbortSet.insert(key);
+  }
+  if ( code != SatBool3::True ) {
+    // マージされないので後の検査で参照される．
+    freeze_node(node);
   }
   mCheckConstInfo.set_result(code, timer.get_time());
+  record_query(timer.get_time());
   return code;
 }
 
@@ -491,26 +1867,50 @@ FraigMgrImpl::check_const(FraigNode* node,
 SatBool3
 FraigMgrImpl::check_equiv(FraigNode* node1,
 			  FraigNode* node2,
-			  bool inv)
+			  bool inv,
+			  bool merge)
 {
-  SatLiteral id1 = node1->varid();
-  SatLiteral id2 = node2->varid();
-
   if ( debug ) {
     cout << "CHECK EQUIV  "
-	 << setw(6) << id1 << " "
-	 << setw(6) << id2;
+	 << setw(6) << node1->id() << " "
+	 << setw(6) << node2->id();
     if ( inv ) {
       cout << " N";
     }
     cout.flush();
   }
 
+  // 真理値表の検査はアボートしないので SAT より先に行う．
+  SatBool3 tt_stat = try_truth_table(node1, node2, inv);
+  if ( tt_stat != SatBool3::X ) {
+    return tt_stat;
+  }
+
+  // ノード番号の小さい方を上位に置いたキー
+  ymuint64 nid1 = std::min(node1->id(), node2->id());
+  ymuint64 nid2 = std::max(node1->id(), node2->id());
+  ymuint64 key = (((nid1 << 31) | nid2) << 1) | (inv ? 1 : 0);
+  if ( mSkipAborted && mEquivAbortSet.count(key) > 0 ) {
+    // 以前にアボートしたので調べない．
+    if ( debug ) {
+      cout << "\tSKIPPED" << endl;
+    }
+    ++ mCheckEquivInfo.mSkipCount;
+    return SatBool3::X;
+  }
+
+  check_rebuild();
+  mLastCexValid = false;
+
   Timer timer;
   timer.start();
 
-  SatLiteral lit1(id1);
-  SatLiteral lit2(id2, inv);
+  // ミタ回路を用いる場合は node2 が仮定に含まれないので
+  // 最初から凍結しておく必要がある．
+  load_cnf(node1);
+  load_cnf(node2, !merge || mMiterCheck);
+  SatLiteral lit1(node1->varid());
+  SatLiteral lit2(node2->varid(), inv);
 
   // この関数の戻り値
   SatBool3 code = SatBool3::X;
@@ -518,22 +1918,31 @@ FraigMgrImpl::check_equiv(FraigNode* node1,
   // 等価でない条件
   // - lit1 = 0 かつ lit2 = 1 が成り立つ
   // - lit0 = 1 かつ lit2 = 0 が成り立つ
-  SatBool3 stat = check_condition(~lit1,  lit2);
-  if ( stat == SatBool3::False ) {
-    stat = check_condition( lit1, ~lit2);
+  // ミタ回路を用いる場合は両方を1回で調べる．
+  SatBool3 stat;
+  if ( mMiterCheck ) {
+    stat = check_miter(lit1, lit2, mCheckEquivLimit);
+  }
+  else {
+    stat = check_condition(~lit1,  lit2, mCheckEquivLimit);
     if ( stat == SatBool3::False ) {
-      // どの条件も成り立たなかったので等しい
-      mSolver.add_clause(~lit1,  lit2);
-      mSolver.add_clause( lit1, ~lit2);
+      stat = check_condition( lit1, ~lit2, mCheckEquivLimit);
+    }
+  }
+  if ( stat == SatBool3::X && !mPortfolio.mTypeList.empty() ) {
+    stat = race(node1, node2, inv);
+  }
+  if ( stat == SatBool3::False ) {
+    // どの条件も成り立たなかったので等しい
+    mSolver->add_clause(~lit1,  lit2);
+    mSolver->add_clause( lit1, ~lit2);
 
-      if ( debug ) {
-	cout << "\tSUCCEED" << endl;
-      }
-      code = SatBool3::True;
-      goto end;
+    if ( debug ) {
+      cout << "\tSUCCEED" << endl;
     }
+    code = SatBool3::True;
   }
-  if ( stat == SatBool3::True ) {
+  else if ( stat == SatBool3::True ) {
     if ( debug ) {
       cout << "\tFAILED" << endl;
     }
@@ -543,29 +1952,36 @@ FraigMgrImpl::check_equiv(FraigNode* node1,
     if ( debug ) {
       cout << "\tABORTED" << endl;
     }
+    mEquivAbortSet.insert(key);
+  }
+  if ( code != SatBool3::True ) {
+    // マージされないので後の検査で参照される．
+    freeze_node(node2);
   }
 
- end:
   mCheckEquivInfo.set_result(code, timer.get_time());
+  record_query(timer.get_time());
   return code;
 }
 
 // lit1 が成り立つか調べる．
 SatBool3
-FraigMgrImpl::check_condition(SatLiteral lit1)
+FraigMgrImpl::check_condition(SatLiteral lit1,
+			      const SatLimit& limit)
 {
   vector<SatLiteral> assumptions{lit1};
-  SatBool3 ans1 = mSolver.solve(assumptions);
+  SatBool3 ans1 = solve(assumptions, limit);
 
 #if defined(VERIFY_SATSOLVER)
   SatSolver solver(nullptr, "minisat");
-  for ( auto node: mAllNodes ) {
+  for ( int i: Range(node_num()) ) {
+    FraigNode* node = mNodePageList[i >> kPageBits] + (i & kPageMask);
     SatVarId id = solver.new_variable();
     ASSERT_COND(id == node->varid() );
     if ( node->is_and() ) {
       SatLiteral lito(id, false);
-      SatLiteral lit1(node->fanin0()->varid(), node->fanin0_inv());
-      SatLiteral lit2(node->fanin1()->varid(), node->fanin1_inv());
+      SatLiteral lit1(fanin_node(node, 0)->varid(), node->fanin0_inv());
+      SatLiteral lit2(fanin_node(node, 1)->varid(), node->fanin1_inv());
       solver.add_clause(~lit1, ~lit2, lito);
       solver.add_clause( lit1, ~lito);
       solver.add_clause( lit2, ~lito);
@@ -578,12 +1994,13 @@ FraigMgrImpl::check_condition(SatLiteral lit1)
     cout << " ans1 = " << ans1 << endl;
     cout << " ans2 = " << ans2 << endl;
     cout << " clauses" << endl;
-    for ( auto node: mAllNodes ) {
+    for ( int i: Range(node_num()) ) {
+      FraigNode* node = mNodePageList[i >> kPageBits] + (i & kPageMask);
       if ( node->is_and() ) {
 	SatVarId id = node->varid();
 	SatLiteral lito(id, false);
-	SatLiteral lit1(node->fanin0()->varid(), node->fanin0_inv());
-	SatLiteral lit2(node->fanin1()->varid(), node->fanin1_inv());
+	SatLiteral lit1(fanin_node(node, 0)->varid(), node->fanin0_inv());
+	SatLiteral lit2(fanin_node(node, 1)->varid(), node->fanin1_inv());
 	cout << "   " << ~lit1 << " + " << ~lit2 << " + " << lito << endl;
 	cout << "   " << lit1 << " + " << ~lito << endl;
 	cout << "   " << lit2 << " + " << ~lito << endl;
@@ -597,20 +2014,22 @@ FraigMgrImpl::check_condition(SatLiteral lit1)
 // lit1 & lit2 が成り立つか調べる．
 SatBool3
 FraigMgrImpl::check_condition(SatLiteral lit1,
-			      SatLiteral lit2)
+			      SatLiteral lit2,
+			      const SatLimit& limit)
 {
   vector<SatLiteral> assumptions{lit1, lit2};
-  SatBool3 ans1 = mSolver.solve(assumptions);
+  SatBool3 ans1 = solve(assumptions, limit);
 
 #if defined(VERIFY_SATSOLVER)
   SatSolver solver(nullptr, "minisat");
-  for ( auto node: mAllNodes ) {
+  for ( int i: Range(node_num()) ) {
+    FraigNode* node = mNodePageList[i >> kPageBits] + (i & kPageMask);
     SatVarId id = solver.new_variable();
     ASSERT_COND(id == node->varid() );
     if ( node->is_and() ) {
       SatLiteral lito(id, false);
-      SatLiteral lit1(node->fanin0()->varid(), node->fanin0_inv());
-      SatLiteral lit2(node->fanin1()->varid(), node->fanin1_inv());
+      SatLiteral lit1(fanin_node(node, 0)->varid(), node->fanin0_inv());
+      SatLiteral lit2(fanin_node(node, 1)->varid(), node->fanin1_inv());
       solver.add_clause(~lit1, ~lit2, lito);
       solver.add_clause(lit1, ~lito);
       solver.add_clause(lit2, ~lito);
@@ -624,12 +2043,13 @@ FraigMgrImpl::check_condition(SatLiteral lit1,
     cout << " ans1 = " << ans1 << endl;
     cout << " ans2 = " << ans2 << endl;
     cout << " clauses" << endl;
-    for ( auto node: mAllNodes ) {
+    for ( int i: Range(node_num()) ) {
+      FraigNode* node = mNodePageList[i >> kPageBits] + (i & kPageMask);
       if ( node->is_and() ) {
 	SatVarId id = node->varid();
 	SatLiteral lito(id, false);
-	SatLiteral lit1(node->fanin0()->varid(), node->fanin0_inv());
-	SatLiteral lit2(node->fanin1()->varid(), node->fanin1_inv());
+	SatLiteral lit1(fanin_node(node, 0)->varid(), node->fanin0_inv());
+	SatLiteral lit2(fanin_node(node, 1)->varid(), node->fanin1_inv());
 	cout << "   " << ~lit1 << " + " << ~lit2 << " + " << lito << endl;
 	cout << "   " << lit1 << " + " << ~lito << endl;
 	cout << "   " << lit2 << " + " << ~lito << endl;
@@ -640,6 +2060,334 @@ FraigMgrImpl::check_condition(SatLiteral lit1,
   return ans1;
 }
 
+// @brief lit1 と lit2 の値が異なることがあるか調べる．
+SatBool3
+FraigMgrImpl::check_miter(SatLiteral lit1,
+			  SatLiteral lit2,
+			  const SatLimit& limit)
+{
+  // act が 1 の時のみ lit1 != lit2 を要求する節を加える．
+  SatLiteral act(mSolver->new_variable());
+  mSolver->freeze_literal(act);
+  mSolver->add_clause(~act,  lit1,  lit2);
+  mSolver->add_clause(~act, ~lit1, ~lit2);
+
+  // 反例を取り出すまではモデルを保持しておきたいので
+  // act の無効化は次の solve() まで遅らせる．
+  mActLitList.push_back(act);
+
+  vector<SatLiteral> assumptions{act};
+  return solve(assumptions, limit);
+}
+
+// @brief 予算をセットして SAT 問題を解く．
+SatBool3
+FraigMgrImpl::solve(const vector<SatLiteral>& assumptions,
+		    const SatLimit& limit)
+{
+  // 使い終わった活性化リテラルを無効化する．
+  // ただし今回使うものは除く．
+  vector<SatLiteral> keep_list;
+  for ( auto act: mActLitList ) {
+    if ( std::find(assumptions.begin(), assumptions.end(), act)
+	 != assumptions.end() ) {
+      keep_list.push_back(act);
+    }
+    else {
+      mSolver->add_clause(~act);
+    }
+  }
+  mActLitList.swap(keep_list);
+
+  // 予算は呼び出しごとに現在の値からの相対値で設定される．
+  mSolver->set_conflict_budget(limit.mConflict);
+  mSolver->set_propagation_budget(limit.mPropagation);
+  return mSolver->solve(assumptions, limit.mTime);
+}
+
+// @brief サポートが小さい場合に全入力パタンで検査を行う．
+SatBool3
+FraigMgrImpl::check_truth_table(FraigNode* node1,
+				FraigNode* node2,
+				bool inv,
+				vector<bool>& cex) const
+{
+  // サポートの和集合を入力番号の昇順に求める．
+  if ( node2->mSupportNum < 0 ||
+       (node1 != nullptr && node1->mSupportNum < 0) ) {
+    return SatBool3::X;
+  }
+  auto begin2 = mSupportPool.begin() + node2->mSupportPos;
+  auto end2 = begin2 + node2->mSupportNum;
+  vector<int> sup_list;
+  if ( node1 == nullptr ) {
+    sup_list.assign(begin2, end2);
+  }
+  else {
+    auto begin1 = mSupportPool.begin() + node1->mSupportPos;
+    auto end1 = begin1 + node1->mSupportNum;
+    std::set_union(begin1, end1, begin2, end2, std::back_inserter(sup_list));
+    if ( sup_list.size() > kMaxSupport ) {
+      return SatBool3::X;
+    }
+  }
+
+  // ファンインコーンのノードを集める．
+  // サポートに含まれない入力がコーンに現れることはない．
+  std::unordered_map<int, int> pos_map;
+  vector<FraigNode*> node_list;
+  vector<FraigNode*> node_stack{node2};
+  if ( node1 != nullptr ) {
+    node_stack.push_back(node1);
+  }
+  while ( !node_stack.empty() ) {
+    FraigNode* node = node_stack.back();
+    node_stack.pop_back();
+    if ( pos_map.count(node->id()) > 0 ) {
+      continue;
+    }
+    pos_map.emplace(node->id(), 0);
+    node_list.push_back(node);
+    if ( node->is_and() ) {
+      node_stack.push_back(fanin_node(node, 0));
+      node_stack.push_back(fanin_node(node, 1));
+    }
+  }
+  sort(node_list.begin(), node_list.end(),
+       [](FraigNode* a, FraigNode* b) { return a->id() < b->id(); });
+
+  // ノード番号の順に全パタンを計算する．
+  // j 番めの入力は minterm 番号の j ビットめの値を取る．
+  static const ymuint64 kVarPat[6] = {
+    0xAAAAAAAAAAAAAAAAULL,
+    0xCCCCCCCCCCCCCCCCULL,
+    0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL,
+    0xFFFF0000FFFF0000ULL,
+    0xFFFFFFFF00000000ULL
+  };
+  int ni = sup_list.size();
+  int nw = ni > 6 ? 1 << (ni - 6) : 1;
+  int nn = node_list.size();
+  if ( node_list.size() * nw > kMaxTruthTableWords ) {
+    return SatBool3::X;
+  }
+  vector<ymuint64> buf(nn * nw);
+  for ( int i = 0; i < nn; ++ i ) {
+    FraigNode* node = node_list[i];
+    pos_map[node->id()] = i * nw;
+    ymuint64* dst = &buf[i * nw];
+    if ( node->is_input() ) {
+      int j = std::lower_bound(sup_list.begin(), sup_list.end(),
+			       node->input_id()) - sup_list.begin();
+      ASSERT_COND( j < ni && sup_list[j] == node->input_id() );
+      for ( int w = 0; w < nw; ++ w ) {
+	if ( j < 6 ) {
+	  dst[w] = kVarPat[j];
+	}
+	else {
+	  dst[w] = ((w >> (j - 6)) & 1) ? ~0ULL : 0ULL;
+	}
+      }
+    }
+    else {
+      const ymuint64* src0 = &buf[pos_map[node->fanin0_id()]];
+      const ymuint64* src1 = &buf[pos_map[node->fanin1_id()]];
+      SimKernel::and_pat(dst, src0, src1, nw,
+			 node->fanin0_inv(), node->fanin1_inv());
+    }
+  }
+
+  // 値の異なる minterm を探す．
+  // ni < 6 の時は 1 ワードの下位 2^ni ビットのみが有効
+  ymuint64 valid = ni >= 6 ? ~0ULL : (1ULL << (1 << ni)) - 1ULL;
+  ymuint64 mask = inv ? ~0ULL : 0ULL;
+  const ymuint64* pat2 = &buf[pos_map[node2->id()]];
+  const ymuint64* pat1 = node1 != nullptr ? &buf[pos_map[node1->id()]] : nullptr;
+  for ( int w = 0; w < nw; ++ w ) {
+    ymuint64 diff = pat2[w] ^ mask;
+    if ( pat1 != nullptr ) {
+      diff ^= pat1[w];
+    }
+    diff &= valid;
+    if ( diff != 0ULL ) {
+      int b = 0;
+      for ( ; ((diff >> b) & 1ULL) == 0ULL; ++ b ) ;
+      int m = w * 64 + b;
+      cex.clear();
+      cex.resize(input_num(), false);
+      for ( int j = 0; j < ni; ++ j ) {
+	if ( (m >> j) & 1 ) {
+	  cex[sup_list[j]] = true;
+	}
+      }
+      return SatBool3::False;
+    }
+  }
+  return SatBool3::True;
+}
+
+// @brief 真理値表による検査を試みる．
+SatBool3
+FraigMgrImpl::try_truth_table(FraigNode* node1,
+			      FraigNode* node2,
+			      bool inv)
+{
+  Timer timer;
+  timer.start();
+  SatBool3 stat = check_truth_table(node1, node2, inv, mLastCex);
+  if ( stat == SatBool3::X ) {
+    return SatBool3::X;
+  }
+
+  mLastCexValid = (stat == SatBool3::False);
+  mTruthTableInfo.set_result(stat, timer.get_time());
+  if ( debug ) {
+    if ( stat == SatBool3::True ) {
+      cout << "\tSUCCEED (truth table)" << endl;
+    }
+    else {
+      cout << "\tFAILED (truth table)" << endl;
+    }
+  }
+  return stat;
+}
+
+// @brief ノードのサポートを求める．
+void
+FraigMgrImpl::calc_support(FraigNode* node)
+{
+  node->mSupportPos = -1;
+  node->mSupportNum = -1;
+  if ( node->is_input() ) {
+    node->mSupportPos = mSupportPool.size();
+    node->mSupportNum = 1;
+    mSupportPool.push_back(node->input_id());
+    return;
+  }
+
+  FraigNode* inode0 = fanin_node(node, 0);
+  FraigNode* inode1 = fanin_node(node, 1);
+  if ( inode0->mSupportNum < 0 || inode1->mSupportNum < 0 ) {
+    return;
+  }
+
+  // ファンインのリストをマージする．
+  // mSupportPool は伸びていくので位置で参照する．
+  int pos = mSupportPool.size();
+  int i0 = inode0->mSupportPos;
+  int e0 = i0 + inode0->mSupportNum;
+  int i1 = inode1->mSupportPos;
+  int e1 = i1 + inode1->mSupportNum;
+  while ( i0 < e0 || i1 < e1 ) {
+    int v;
+    if ( i1 == e1 || (i0 < e0 && mSupportPool[i0] < mSupportPool[i1]) ) {
+      v = mSupportPool[i0];
+      ++ i0;
+    }
+    else if ( i0 == e0 || mSupportPool[i1] < mSupportPool[i0] ) {
+      v = mSupportPool[i1];
+      ++ i1;
+    }
+    else {
+      v = mSupportPool[i0];
+      ++ i0;
+      ++ i1;
+    }
+    mSupportPool.push_back(v);
+    if ( mSupportPool.size() - pos > kMaxSupport ) {
+      mSupportPool.resize(pos);
+      return;
+    }
+  }
+  node->mSupportPos = pos;
+  node->mSupportNum = mSupportPool.size() - pos;
+}
+
+// @brief ポートフォリオの SAT ソルバを競争させて検査を行う．
+SatBool3
+FraigMgrImpl::race(FraigNode* node1,
+		   FraigNode* node2,
+		   bool inv)
+{
+  Timer timer;
+  timer.start();
+
+  // ソルバは前の競争で作ったものを使い回す．
+  // 読み込み済みの CNF は garbage_collect() まで有効
+  int n = mPortfolio.mTypeList.size();
+  ASSERT_COND( n <= mSimEngine.thread_num() );
+  auto& worker_list = mPortfolio.mWorkerList;
+  if ( worker_list.empty() ) {
+    const SatLimit& limit = mPortfolio.mLimit;
+    for ( int i = 0; i < n; ++ i ) {
+      worker_list.emplace_back(new SweepWorker(*this, mPortfolio.mTypeList[i],
+					       limit.mConflict,
+					       limit.mPropagation,
+					       limit.mTime));
+    }
+  }
+  vector<SweepQuery> query_list(n, SweepQuery(node1, node2, inv));
+  for ( auto& worker: worker_list ) {
+    worker->clear_stop();
+  }
+
+  // 最初に答えを出したソルバが残りのソルバを止める．
+  // SAT を解き始める直前の stop() は取りこぼされることがあるので
+  // 勝ったソルバのスレッドが残りのジョブが終わるまで繰り返す．
+  std::mutex mutex;
+  std::condition_variable cond;
+  int winner = -1;
+  int remain = n;
+  auto job = [&](int i) {
+    Timer timer1;
+    timer1.start();
+    worker_list[i]->check(query_list[i]);
+    query_list[i].mTime = timer1.get_time();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    -- remain;
+    if ( winner == -1 && query_list[i].mResult != SatBool3::X ) {
+      winner = i;
+      while ( remain > 0 ) {
+	for ( int j = 0; j < n; ++ j ) {
+	  if ( j != i ) {
+	    worker_list[j]->stop();
+	  }
+	}
+	cond.wait_for(lock, std::chrono::milliseconds(1));
+      }
+    }
+    else {
+      cond.notify_all();
+    }
+  };
+  mSimEngine.run(n, job);
+
+  ++ mPortfolio.mRaceCount;
+  mPortfolio.mTime += timer.get_time();
+  if ( winner == -1 ) {
+    ++ mPortfolio.mAbortCount;
+    return SatBool3::X;
+  }
+
+  ++ mPortfolio.mWinCount[winner];
+  mPortfolio.mWinTime[winner] += query_list[winner].mTime;
+  if ( debug ) {
+    cout << " [PORTFOLIO #" << winner << "]";
+  }
+
+  SatBool3 stat = query_list[winner].mResult;
+  if ( stat == SatBool3::True ) {
+    // 呼び出し側の検査の結果に合わせて
+    // 成り立つ条件が見つからなかったことを表す．
+    return SatBool3::False;
+  }
+  mLastCex.swap(query_list[winner].mCex);
+  mLastCexValid = true;
+  return SatBool3::True;
+}
+
 #if 0
 // @brief FraigHandle に対応するリテラルを返す．
 // @note 定数の場合の返り値は未定
@@ -649,7 +2397,7 @@ FraigMgrImpl::fraig2literal(FraigHandle aig)
   if ( aig.is_const() ) {
     return SatLiteral(SatVarId(0), false);
   }
-  SatVarId id = aig.node()->varid();
+  SatVarId id = node(aig.node_id())->varid();
   bool inv = aig.inv();
   return SatLiteral(id, inv);
 }
@@ -690,6 +2438,25 @@ FraigMgrImpl::dump_eqgroup(ostream& s) const
 }
 #endif
 
+// @brief SAT ソルバに CNF の前処理を行わせる．
+void
+FraigMgrImpl::preprocess_cnf()
+{
+  // SAT ソルバの前処理は solve() の中で行われるので
+  // 仮定なしで1回だけ解く．
+  // 探索自体は必要ないのでコンフリクト数の予算は最小にする．
+  // 使い終わった活性化リテラルもここで無効化される．
+  Timer timer;
+  timer.start();
+  SizeType old_num = mSolver->clause_num();
+  solve(vector<SatLiteral>{}, SatLimit{1, 0, 0});
+  if ( debug ) {
+    cout << "PREPROCESS CNF: "
+	 << old_num << " -> " << mSolver->clause_num() << " clauses, "
+	 << timer.get_time() << " sec." << endl;
+  }
+}
+
 // @brief 直前の sat_sweep に関する統計情報を出力する．
 void
 FraigMgrImpl::dump_stats(ostream& s)
@@ -704,10 +2471,73 @@ FraigMgrImpl::dump_stats(ostream& s)
   s << "----------------------------------" << endl;
   s << "check_equiv:" << endl;
   mCheckEquivInfo.dump(s);
+  s << "----------------------------------" << endl;
+  s << "sweep:" << endl;
+  mSweepInfo.dump(s);
+  s << "----------------------------------" << endl;
+  s << "truth table:" << endl;
+  mTruthTableInfo.dump(s);
+  {
+    // 節約した時間は SAT を用いた検査の平均時間から見積もる．
+    int sat_num = 0;
+    double sat_time = 0.0;
+    for ( auto info: { &mCheckConstInfo, &mCheckEquivInfo, &mSweepInfo } ) {
+      for ( auto i: { 0, 1, 2 } ) {
+	sat_num += info->mTimeStat[i].mCount;
+	sat_time += info->mTimeStat[i].mTotalTime;
+      }
+    }
+    int tt_num = mTruthTableInfo.mTotalCount;
+    double tt_time = 0.0;
+    for ( auto i: { 0, 1, 2 } ) {
+      tt_time += mTruthTableInfo.mTimeStat[i].mTotalTime;
+    }
+    if ( tt_num + sat_num > 0 ) {
+      s << " hit rate " << (100.0 * tt_num / (tt_num + sat_num))
+	<< "% of all checks" << endl;
+    }
+    if ( sat_num > 0 ) {
+      s << " saved " << (sat_time / sat_num * tt_num - tt_time)
+	<< " sec. (estimated)" << endl;
+    }
+  }
+  s << "----------------------------------" << endl;
+  s << "quantify:" << endl
+    << " total " << mQuantifyInfo.mCallCount << " calls, "
+    << mQuantifyInfo.mVarCount << " inputs eliminated" << endl
+    << " total " << mQuantifyInfo.mTime << " sec." << endl;
+  if ( mQuantifyInfo.mVarCount > 0 ) {
+    s << " growth " << mQuantifyInfo.mTotalGrowth << " nodes (ave. "
+      << (static_cast<double>(mQuantifyInfo.mTotalGrowth) / mQuantifyInfo.mVarCount)
+      << ", max " << mQuantifyInfo.mMaxGrowth << " per input)" << endl;
+  }
+  s << "----------------------------------" << endl;
+  s << "solver rebuild:" << endl
+    << " total " << mRebuildInfo.mCount << " times" << endl
+    << " total " << mRebuildInfo.mTime << " sec." << endl
+    << " saved " << mRebuildInfo.mSavedTime << " sec. (estimated)" << endl
+    << " current " << mSolver->variable_num() << " vars ("
+    << mFrozenNum << " frozen), "
+    << mSolver->clause_num() << " clauses" << endl;
+  s << "----------------------------------" << endl;
+  s << "portfolio:" << endl
+    << " total " << mPortfolio.mRaceCount << " races ("
+    << mPortfolio.mAbortCount << " aborted)" << endl
+    << " total " << mPortfolio.mTime << " sec." << endl;
+  int np = mPortfolio.mTypeList.size();
+  for ( int i = 0; i < np; ++ i ) {
+    const SatSolverType& type = mPortfolio.mTypeList[i];
+    s << " #" << i << " " << type.type();
+    if ( type.option() != string() ) {
+      s << "(" << type.option() << ")";
+    }
+    s << ": " << mPortfolio.mWinCount[i] << " wins, "
+      << mPortfolio.mWinTime[i] << " sec." << endl;
+  }
   s << endl;
 
   SatStats stats;
-  mSolver.get_stats(stats);
+  mSolver->get_stats(stats);
   s << "----------------------------------" << endl;
   s << "sat stat:" << endl
     << "  restarts          : " << stats.mRestart << endl
@@ -720,6 +2550,7 @@ FraigMgrImpl::dump_stats(ostream& s)
 FraigMgrImpl::SatStat::SatStat()
 {
   mTotalCount = 0;
+  mSkipCount = 0;
   for ( auto i: { 0, 1, 2 } ) {
     mTimeStat[i].mCount = 0;
     mTimeStat[i].mTotalTime = 0.0;
@@ -770,6 +2601,9 @@ FraigMgrImpl::SatStat::dump(ostream& s) const
       << mTimeStat[0].mTotalTime / mTimeStat[0].mCount << " / "
       << mTimeStat[0].mMaxTime << endl;
   }
+  if ( mSkipCount > 0 ) {
+    s << " Skipped(aborted before): " << mSkipCount << endl;
+  }
 }
 
 END_NAMESPACE_FRAIG
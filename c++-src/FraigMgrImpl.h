@@ -11,14 +11,19 @@
 
 #include "ym/fraig.h"
 #include "ym/FraigHandle.h"
+#include "FraigNode.h"
 #include "StructHash.h"
-#include "PatHash.h"
+#include "EqClassMgr.h"
+#include "PatMgr.h"
+#include "SimEngine.h"
+#include "SweepWorker.h"
 #include "ym/Expr.h"
 #include "ym/SatBool3.h"
 #include "ym/SatSolverType.h"
 #include "ym/SatSolver.h"
 #include "ym/SatModel.h"
 #include <random>
+#include <unordered_set>
 
 
 BEGIN_NAMESPACE_FRAIG
@@ -62,9 +67,24 @@ public:
   /// @brief ノードを取り出す．
   /// @param[in] pos ノード番号 ( 0 <= pos < input_num() )
   /// @note ANDノードの他に入力ノードも含まれる．
+  /// @note ノード番号 0 は定数ノード用に予約されている．
   FraigNode*
   node(int pos) const;
 
+  /// @brief ファンインのハンドルを得る．
+  /// @param[in] node 対象のノード
+  /// @param[in] pos 位置 ( 0 or 1 )
+  FraigHandle
+  fanin_handle(FraigNode* node,
+	       int pos) const;
+
+  /// @brief 代表ノードをたどったハンドルを返す．
+  /// @param[in] handle 対象のハンドル
+  ///
+  /// 代表ノードが鎖になっている場合も最後までたどる．
+  FraigHandle
+  resolve_rep(FraigHandle handle) const;
+
 
 public:
   //////////////////////////////////////////////////////////////////////
@@ -81,6 +101,44 @@ public:
   make_and(FraigHandle edge1,
 	   FraigHandle edge2);
 
+  /// @brief 入力を量化した関数を作る．
+  /// @param[in] edge 対象の AIG ハンドル
+  /// @param[in] input_list 量化する入力番号のリスト
+  /// @param[in] forall 全称量化の時 true，存在量化の時 false にする．
+  ///
+  /// 依存するノード数が最も少ない入力から順に消去する．
+  /// 1つの入力の両方のコファクターは1回のたどりで同時に作り，
+  /// 結果の OR (AND) は make_and() でマージされながら作られる．
+  /// ノードごとの依存する入力の表は入力ごとに作り直さず，
+  /// 新しく現れたノードの分だけ追加する．
+  /// 入力ごとのノード数の増加はログと dump_stats() に出力される．
+  FraigHandle
+  quantify(FraigHandle edge,
+	   const vector<int>& input_list,
+	   bool forall);
+
+  /// @brief 使われていないノードを削除する．
+  /// @param[in] root_list 使用中のハンドルのリスト
+  ///
+  /// root_list と入力ノードから到達できないノードを削除し，
+  /// ノード番号を詰める．
+  /// root_list の内容は新しいハンドルに書き換えられる．
+  void
+  garbage_collect(vector<FraigHandle>& root_list);
+
+  /// @brief SAT スイープを行う．
+  /// @param[in] root_list 使用中のハンドルのリスト
+  ///
+  /// 等価候補のクラスに残っているノード対と定数の候補を調べて
+  /// 等価なノードをマージし，ファンアウトを代表ノードにつなぎ替える．
+  /// 検査は対象のノード番号の順(トポロジカル順)に並べ，
+  /// スレッドごとに別の SAT ソルバを用いて並列に行う．
+  /// バッチモードの時は最初にランダムパタンを加えてクラスを分割する．
+  /// 結果は検査の順番に反映するので，スレッド数が同じなら結果は決定的
+  /// 最後に garbage_collect(root_list) を行う．
+  void
+  sweep(vector<FraigHandle>& root_list);
+
 
 public:
   //////////////////////////////////////////////////////////////////////
@@ -105,29 +163,349 @@ public:
   void
   set_loop_limit(int loop_limit);
 
+  /// @brief シミュレーションと sweep() に用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// ポートフォリオのソルバ数より少ない場合はソルバ数にする．
+  void
+  set_thread_num(int num);
+
+  /// @brief check_const で用いる SAT の予算を設定する．
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// どれも 0 の場合は制限なしを表す．
+  /// 予算を使い切った検査はアボート(SatBool3::X)となる．
+  void
+  set_check_const_limit(SizeType conflict_limit,
+			SizeType propagation_limit = 0,
+			int time_limit = 0);
+
+  /// @brief check_equiv で用いる SAT の予算を設定する．
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// どれも 0 の場合は制限なしを表す．
+  /// 予算を使い切った検査はアボート(SatBool3::X)となる．
+  void
+  set_check_equiv_limit(SizeType conflict_limit,
+			SizeType propagation_limit = 0,
+			int time_limit = 0);
+
+  /// @brief sweep() で用いる SAT の予算を設定する．
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// どれも 0 の場合は制限なしを表す．
+  void
+  set_sweep_limit(SizeType conflict_limit,
+		  SizeType propagation_limit = 0,
+		  int time_limit = 0);
+
+  /// @brief 一度アボートした検査を再び行わないかどうかを設定する．
+  /// @param[in] flag true の時は同じ検査を行わずにアボートとして扱う．
+  ///
+  /// デフォルトは true
+  void
+  set_skip_aborted(bool flag);
+
+  /// @brief 等価検査をミタ回路を用いた1回の SAT で行うかどうかを設定する．
+  /// @param[in] flag true の時は活性化リテラルつきのミタ回路を用いる．
+  ///
+  /// false の時は2つの含意をそれぞれ SAT で調べる．
+  /// デフォルトは false
+  void
+  set_miter_check(bool flag);
+
+  /// @brief 構築中の検査を sweep() にまとめるかどうかを設定する．
+  /// @param[in] flag true の時は make_and() で SAT を用いない．
+  /// @param[in] sim_words sweep() の最初に加えるランダムパタンのワード数
+  ///
+  /// デフォルトは false
+  void
+  set_batch_mode(bool flag,
+		 int sim_words = 32);
+
+  /// @brief バッチモードの時 true を返す．
+  bool
+  batch_mode() const;
+
+  /// @brief バッチモードの sweep() の最初に加えるランダムパタンのワード数を返す．
+  int
+  batch_sim_words() const;
+
+  /// @brief SAT ソルバを作り直す条件を設定する．
+  /// @param[in] clause_limit 節数の上限
+  /// @param[in] var_limit 変数の数の上限
+  /// @param[in] time_ratio 平均検査時間の悪化率の上限
+  ///
+  /// どれかの条件を超えたら次の検査の前にソルバを作り直す．
+  /// time_ratio は作り直した直後の平均検査時間に対する比率
+  /// どれも 0 の場合は用いない．デフォルトはどれも 0
+  void
+  set_rebuild_limit(SizeType clause_limit,
+		    SizeType var_limit = 0,
+		    double time_ratio = 0.0);
+
+  /// @brief ポートフォリオに用いる SAT ソルバを設定する．
+  /// @param[in] type_list SAT ソルバの種類のリスト
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// check_const や check_equiv の予算でアボートした検査を
+  /// type_list の各ソルバで別々のスレッドで解かせ，
+  /// 最初に答えを出したものを採用して残りは中止させる．
+  /// ソルバはシミュレーションと同じスレッドプールで動かすので
+  /// スレッド数がソルバ数より少ない場合はソルバ数まで増やす．
+  /// 上限は各ソルバの1回の SAT ごとに適用される．0 は制限なしを表す．
+  /// type_list が空の場合は用いない．デフォルトは空
+  void
+  set_portfolio(const vector<SatSolverType>& type_list,
+		SizeType conflict_limit = 0,
+		SizeType propagation_limit = 0,
+		int time_limit = 0);
+
+  /// @brief SAT ソルバに CNF の前処理を行わせる．
+  ///
+  /// 凍結されていない変数(マージされたノードの変数)が
+  /// SAT ソルバの変数除去の対象になる．
+  /// 多数の検査を行う前に呼ぶと以降の SAT が速くなる場合がある．
+  void
+  preprocess_cnf();
+
   /// @brief 内部の統計情報を出力する．
   void
   dump_stats(ostream& s);
 
+  /// @brief ポートフォリオのソルバを競争させた回数を返す．
+  int
+  race_count() const;
+
+  /// @brief ランダムシミュレーションで加えたパタンのワード数を返す．
+  int
+  sim_count() const;
+
 
 public:
   //////////////////////////////////////////////////////////////////////
-  // PatHash で用いられる関数
+  // EqClassMgr で用いられる関数
   //////////////////////////////////////////////////////////////////////
 
-  /// @brief パタンハッシュで同値と判定されたノードを比較する．
+  /// @brief 同じクラスに属するノードを比較する．
+  /// @param[in] node1 クラスに属しているノード
+  /// @param[in] node2 対象のノード
+  /// @param[in] inv false で同相，true で逆相を表す．
+  /// @param[out] retry クラスが分割されたので探索をやり直す時 true を返す．
+  /// @return 等価だった時 true を返す．
   bool
   compare_node(FraigNode* node1,
 	       FraigNode* node2,
 	       bool inv,
 	       bool& retry);
 
+  /// @brief シミュレーションパタンが等しいか調べる．
+  /// @param[in] node1, node2 対象のノード
+  /// @param[in] inv false で同相，true で逆相を表す．
+  /// @param[in] start 開始位置
+  /// @param[in] end 終了位置
+  ///
+  /// start より前のパタンは等しいことがわかっていなければならない．
+  /// その場合はハッシュ値が異なればパタンを比べずに false を返す．
+  bool
+  compare_pat(FraigNode* node1,
+	      FraigNode* node2,
+	      bool inv,
+	      int start,
+	      int end);
+
+  /// @brief クラスの索引に用いるキーを返す．
+  /// @param[in] node 対象のノード
+  /// @param[in] key start ワードめの手前までのパタンから計算したキー
+  /// @param[in] start 開始位置
+  /// @param[in] end 終了位置
+  ///
+  /// 0 ワードめから end - 1 ワードめまでのパタンから計算したキーを返す．
+  /// キーは1ワードずつ順に畳み込むので途中のキーから続けて計算できる．
+  /// start が 0 の時は key に 0 を与える．
+  SizeType
+  class_key(FraigNode* node,
+	    SizeType key,
+	    int start,
+	    int end);
+
+  /// @brief 最初にクラスのキーの計算に用いるワード数を返す．
+  int
+  class_key_size() const;
+
+  /// @brief 確定したパタン数を返す．
+  int
+  pat_used() const;
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // SweepWorker で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief サポートが小さい場合に全入力パタンで検査を行う．
+  /// @param[in] node1 比較するノード(nullptr の時は定数)
+  /// @param[in] node2 対象のノード
+  /// @param[in] inv 極性(意味は SweepQuery::mInv と同じ)
+  /// @param[out] cex 反例の入力値(入力番号がインデックス)
+  /// @retval SatBool3::True 等価だった．
+  /// @retval SatBool3::False 等価でなかった．反例を cex に格納する．
+  /// @retval SatBool3::X サポートが大きいので調べなかった．
+  ///
+  /// 2つのノードのサポートの和が kMaxSupport 以下の時に
+  /// ファンインコーンを 2^(サポート数) パタンでビット並列にシミュレーションする．
+  /// ノードの内容を読み出すだけなので複数のスレッドから同時に使える．
+  SatBool3
+  check_truth_table(FraigNode* node1,
+		    FraigNode* node2,
+		    bool inv,
+		    vector<bool>& cex) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // 1回の SAT 問題に対する予算
+  // 0 の場合は制限なしを表す．
+  struct SatLimit
+  {
+    // コンフリクト数の上限
+    SizeType mConflict;
+
+    // 含意操作の回数の上限
+    SizeType mPropagation;
+
+    // 時間の上限(秒)
+    int mTime;
+  };
+
+  // SAT ソルバの作り直しに関する情報
+  struct RebuildInfo
+  {
+    // 節数の上限
+    SizeType mClauseLimit;
+
+    // 変数の数の上限
+    SizeType mVarLimit;
+
+    // 平均検査時間の悪化率の上限
+    double mTimeRatio;
+
+    // 作り直した回数
+    int mCount;
+
+    // 作り直しに要した時間
+    double mTime;
+
+    // 直前に作り直してからの検査回数
+    int mQueryNum;
+
+    // 集計中の区間の検査回数
+    int mWindowNum;
+
+    // 集計中の区間の検査時間の総和
+    double mWindowTime;
+
+    // 作り直した直後の区間の平均検査時間
+    // 負の値は未計測を表す．
+    double mBaseAve;
+
+    // 直近の区間の平均検査時間
+    double mLastAve;
+
+    // 直前に作り直す前の平均検査時間
+    // 負の値は未計測を表す．
+    double mPrevAve;
+
+    // 作り直したことで短縮されたと見積もられる検査時間
+    double mSavedTime;
+  };
+
+  // ポートフォリオに関する情報
+  struct PortfolioInfo
+  {
+    // SAT ソルバの種類のリスト
+    vector<SatSolverType> mTypeList;
+
+    // 各ソルバの1回の SAT の予算
+    SatLimit mLimit;
+
+    // 競争させた回数
+    int mRaceCount;
+
+    // どのソルバも答えを出せなかった回数
+    int mAbortCount;
+
+    // 競争に要した時間の総和
+    double mTime;
+
+    // ソルバごとの勝った回数
+    vector<int> mWinCount;
+
+    // ソルバごとの勝った時の時間の総和
+    vector<double> mWinTime;
+
+    // 競争させるソルバ(mTypeList と同じ順)
+    // 読み込んだ CNF を次の競争でも使えるように取っておく．
+    // ノード番号が変わる garbage_collect() で捨てる．
+    vector<unique_ptr<SweepWorker>> mWorkerList;
+  };
+
+  // 量化に関する情報
+  struct QuantifyInfo
+  {
+    // quantify() の呼ばれた回数
+    int mCallCount;
+
+    // 消去した入力の数
+    int mVarCount;
+
+    // 消去した入力ごとのノード数の増加の総和
+    SizeType mTotalGrowth;
+
+    // 1つの入力を消去した時のノード数の増加の最大値
+    SizeType mMaxGrowth;
+
+    // 量化に要した時間の総和
+    double mTime;
+  };
+
 
 private:
   //////////////////////////////////////////////////////////////////////
   // 内部で用いられる関数
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief ノードのファンインコーンの CNF 式を読み込む．
+  /// @param[in] node 対象のノード
+  /// @param[in] freeze node の変数を凍結する時 true にする．
+  ///
+  /// 読み込まれていないノードにのみ変数を割り当てて CNF 式を作る．
+  /// ファンインコーン中の node 以外のノードは入力か代表ノードなので
+  /// 後の検査や CNF で参照される可能性があり，常に凍結する．
+  void
+  load_cnf(FraigNode* node,
+	   bool freeze = true);
+
+  /// @brief ノードの変数を凍結する．
+  /// @param[in] node 対象のノード
+  ///
+  /// 凍結されていない変数は SAT ソルバの前処理で除去される可能性がある．
+  /// 前回 SAT を解いた後で読み込んだか，その時の仮定に含まれていた
+  /// 変数でなければならない．
+  void
+  freeze_node(FraigNode* node);
+
   /// @brief ノードの入出力の関係を表す CNF 式を作る．
   /// @param[in] node 対象のノード
   void
@@ -151,42 +529,185 @@ private:
   FraigHandle
   check_pat(FraigNode* node);
 
-  /// @brief ノードのシミュレーションパタン用配列を確保する．
+  /// @brief パタンをセットする．
   /// @param[in] node 対象のノード
+  /// @param[in] start 開始位置
+  /// @param[in] end 終了位置
+  /// @param[in] pat パタンのベクタ
+  void
+  set_pat(FraigNode* node,
+	  int start,
+	  int end,
+	  const vector<ymuint64>& pat);
+
+  /// @brief ノードのパタンを end ワードめの手前まで計算済みにする．
+  /// @param[in] node 対象のノード
+  /// @param[in] end 終了位置
+  ///
+  /// ファンインコーン中の未計算のノードのみを計算する．
+  void
+  update_pat(FraigNode* node,
+	     int end);
+
+  /// @brief 複数のノードのパタンを end ワードめの手前まで計算済みにする．
+  /// @param[in] root_list 対象のノードのリスト
+  /// @param[in] end 終了位置
+  ///
+  /// ファンインコーン中の未計算のノードのみを計算する．
+  void
+  update_pat(const vector<FraigNode*>& root_list,
+	     int end);
+
+  /// @brief 直前の SAT の反例を保留中のワードに加える．
+  /// @return ワードが一杯になってクラスを分割した時に true を返す．
+  ///
+  /// 反例は 64 個たまるまで1ワードの各ビットに保留しておき，
+  /// 一杯になった時点で全ノードのシミュレーションとクラスの分割を行う．
+  bool
+  add_cex();
+
+  /// @brief 反例を保留中のワードに加える．
+  /// @param[in] cex 反例の入力値(入力番号がインデックス)
+  /// @return ワードが一杯になってクラスを分割した時に true を返す．
+  bool
+  add_cex(const vector<bool>& cex);
+
+  /// @brief 保留中の反例のワードを全ノードでシミュレーションしてクラスを分割する．
   void
-  init_pat(FraigNode* node);
+  flush_cex();
 
-  /// @brief 全ノードのシミュレーションパタン用配列を拡大する．
+  /// @brief ランダムパタンでクラスを分割する．
+  /// @param[in] node1, node2 等価候補のノード対
+  /// @param[in] inv false で同相，true で逆相を表す．
+  /// @return node1 と node2 が区別された時 true を返す．
+  ///
+  /// 乱数を1ワードずつ加えてシミュレーションを行い，
+  /// クラスが分割されない状態が mLoopLimit 回続くか，
+  /// node1 と node2 が区別されるまで繰り返す．
+  /// 分割が起きない状態は呼び出しをまたいで数えられ，
+  /// 反例によってクラスが分割されると 0 に戻る．
+  bool
+  random_sim(FraigNode* node1,
+	     FraigNode* node2,
+	     bool inv);
+
+  /// @brief 入力にセットされた mPatUsed 番目からのワードを確定させてクラスを分割する．
+  /// @param[in] num ワード数
+  /// @return クラスが分割された時 true を返す．
+  bool
+  commit_word(int num = 1);
+
+  /// @brief 保留中の反例のワードをノードのファンインコーンについて計算する．
+  /// @param[in] node 対象のノード
   void
-  resize_pat(int size);
+  eval_cex(FraigNode* node);
 
-  /// @breif 直前の SAT の反例を加えて再ハッシュする．
+  /// @brief 保留中の反例の上で2つのノードの値が等しいか調べる．
+  /// @param[in] node1, node2 対象のノード
+  /// @param[in] inv false で同相，true で逆相を表す．
+  bool
+  compare_cex(FraigNode* node1,
+	      FraigNode* node2,
+	      bool inv);
+
+  /// @brief 保留中の反例の値から 0/1 マークをつける．
+  /// @param[in] node 対象のノード
   void
-  add_pat(FraigNode* node);
+  update_cex_mark(FraigNode* node);
+
+  /// @brief 保留中の反例の有効なビットを表すマスクを返す．
+  ymuint64
+  cex_mask() const;
 
   /// @brief ノードが定数と等価かどうか調べる．
   /// @param[in] node 対象のノード
   /// @param[in] inv false で 0, true で 1 を表す．
+  /// @param[in] merge 等価な時に node をマージする場合 true にする．
+  ///
+  /// merge が true の時は等価でなかった場合のみ node の変数を凍結する．
+  /// マージされたノードの変数は二度と参照されないので凍結する必要はない．
   SatBool3
   check_const(FraigNode* node,
-	      bool inv);
+	      bool inv,
+	      bool merge = false);
 
   /// @brief 2つのノードが等価かどうか調べる．
   /// @param[in] node1, node2 対象のノード
   /// @param[in] inv false で同相，true で逆相を表す．
+  /// @param[in] merge 等価な時に node2 をマージする場合 true にする．
+  ///
+  /// merge の意味は check_const() と同じ
   SatBool3
   check_equiv(FraigNode* node1,
 	      FraigNode* node2,
-	      bool inv);
+	      bool inv,
+	      bool merge = false);
 
   /// @brief lit1 が成り立つか調べる．
+  /// @param[in] lit1 条件
+  /// @param[in] limit SAT の予算
   SatBool3
-  check_condition(SatLiteral lit1);
+  check_condition(SatLiteral lit1,
+		  const SatLimit& limit);
 
   /// @brief lit1 & lit2 が成り立つか調べる．
+  /// @param[in] lit1, lit2 条件
+  /// @param[in] limit SAT の予算
   SatBool3
   check_condition(SatLiteral lit1,
-		  SatLiteral lit2);
+		  SatLiteral lit2,
+		  const SatLimit& limit);
+
+  /// @brief lit1 と lit2 の値が異なることがあるか調べる．
+  /// @param[in] lit1, lit2 対象のリテラル
+  /// @param[in] limit SAT の予算
+  ///
+  /// 活性化リテラルつきのミタ回路を作って1回の SAT で調べる．
+  /// 活性化リテラルは次に SAT を解く時に無効化される．
+  SatBool3
+  check_miter(SatLiteral lit1,
+	      SatLiteral lit2,
+	      const SatLimit& limit);
+
+  /// @brief 予算をセットして SAT 問題を解く．
+  /// @param[in] assumptions 仮定
+  /// @param[in] limit SAT の予算
+  SatBool3
+  solve(const vector<SatLiteral>& assumptions,
+	const SatLimit& limit);
+
+  /// @brief 真理値表による検査を試みる．
+  /// @param[in] node1 比較するノード(nullptr の時は定数)
+  /// @param[in] node2 対象のノード
+  /// @param[in] inv 極性(意味は SweepQuery::mInv と同じ)
+  ///
+  /// 返り値の意味は check_truth_table() と同じ
+  /// 反例は mLastCex に格納し，統計情報を記録する．
+  SatBool3
+  try_truth_table(FraigNode* node1,
+		  FraigNode* node2,
+		  bool inv);
+
+  /// @brief ノードのサポートを求める．
+  /// @param[in] node 対象のノード
+  ///
+  /// ファンインのサポートは求められていなければならない．
+  /// 結果は入力番号の昇順に mSupportPool の末尾に追加する．
+  void
+  calc_support(FraigNode* node);
+
+  /// @brief ポートフォリオの SAT ソルバを競争させて検査を行う．
+  /// @param[in] node1 比較するノード(nullptr の時は定数)
+  /// @param[in] node2 対象のノード
+  /// @param[in] inv 極性(意味は SweepQuery::mInv と同じ)
+  ///
+  /// 返り値の意味は check_condition() と同じで，
+  /// SatBool3::True (条件が成り立つ)の時は反例を mLastCex に格納する．
+  /// どのソルバが勝つかはスレッドの進み方によるので結果は決定的ではない．
+  SatBool3
+  race(FraigNode* node1,
+       FraigNode* node2,
+       bool inv);
 
   /// @brief FraigHandle に対応するリテラルを返す．
   /// @note 定数の場合の返り値は未定
@@ -201,11 +722,53 @@ private:
   FraigNode*
   new_node();
 
-  /// @brief シミュレーションパタンが等しいか調べる．
+  /// @brief sweep() で調べる検査を集める．
+  /// @param[out] query_list 検査のリスト
+  /// @param[in] const_abort_set アボートした定数の検査のキーの集合
+  /// @param[in] equiv_abort_set アボートした等価検査のキーの集合
+  void
+  collect_sweep_query(vector<SweepQuery>& query_list,
+		      const std::unordered_set<ymuint64>& const_abort_set,
+		      const std::unordered_set<ymuint64>& equiv_abort_set);
+
+  /// @brief sweep() の検査がまだ必要か調べる．
+  /// @param[in] query 対象の検査
+  ///
+  /// 前に反映した結果でマージされたり区別されたりした場合は false を返す．
   bool
-  compare_pat(FraigNode* node1,
-	      FraigNode* node2,
-	      bool inv);
+  is_sweep_candidate(const SweepQuery& query);
+
+  /// @brief マージされたノードのファンアウトを代表ノードにつなぎ替える．
+  ///
+  /// ノード番号の小さい順につなぎ替え，構造が同じになったノードもマージする．
+  /// 最後に全てのノードの代表ノードが直接代表ノードを指すようにする．
+  void
+  rewire();
+
+  /// @brief SAT ソルバを作り直す．
+  ///
+  /// 全てのノードの CNF は読み込まれていない状態になる．
+  /// 以降の検査では代表ノードのファンインコーンのみが読み込まれる．
+  void
+  rebuild_solver();
+
+  /// @brief 必要ならば SAT ソルバを作り直す．
+  ///
+  /// mRebuildInfo の条件のどれかを超えていたら作り直す．
+  void
+  check_rebuild();
+
+  /// @brief 1回の検査の時間を記録する．
+  /// @param[in] t 検査時間
+  void
+  record_query(double t);
+
+  /// @brief ファンインのノードを得る．
+  /// @param[in] node 対象のノード
+  /// @param[in] pos 位置 ( 0 or 1 )
+  FraigNode*
+  fanin_node(FraigNode* node,
+	     int pos) const;
 
 
 private:
@@ -220,6 +783,9 @@ private:
     // 試行回数
     int mTotalCount;
 
+    // 以前にアボートしたので行わなかった回数
+    int mSkipCount;
+
     struct
     {
       // 回数
@@ -271,8 +837,26 @@ private:
   // データメンバ
   //////////////////////////////////////////////////////////////////////
 
-  // ID 番号をキーにしたノードの配列
-  vector<FraigNode*> mAllNodes;
+  // 1ページに含まれるノード数の log2
+  static
+  const int kPageBits = 12;
+
+  // 1ページに含まれるノード数
+  static
+  const int kPageSize = 1 << kPageBits;
+
+  // ページ内の位置を取り出すマスク
+  static
+  const int kPageMask = kPageSize - 1;
+
+  // ノードを格納するページのリスト
+  // ページ単位で確保するのでガーベージコレクション以外では
+  // ノードのアドレスは変わらない．
+  // ノード番号 id のノードは mNodePageList[id >> kPageBits][id & kPageMask]
+  vector<FraigNode*> mNodePageList;
+
+  // ノード数
+  int mNodeNum;
 
   // 入力ノードの配列
   vector<FraigNode*> mInputNodes;
@@ -280,8 +864,8 @@ private:
   // 構造ハッシュ
   StructHash mHashTable1;
 
-  // 各ノードのシミュレーションパタンのサイズ
-  int mPatSize;
+  // 全ノードのシミュレーションパタン
+  PatMgr mPatMgr;
 
   // 初期パタン数
   int mPatInit;
@@ -289,30 +873,116 @@ private:
   // 使用しているパタン数
   int mPatUsed;
 
-  // パタンハッシュ
-  PatHash mHashTable2;
+  // 保留中の反例の数
+  // 反例は mPatUsed 番目のワードのビットに格納される．
+  int mCexNum;
+
+  // 保留中の反例が変化するたびに更新されるスタンプ
+  ymuint32 mCexStamp;
+
+  // 等価候補グループ
+  EqClassMgr mClassMgr;
 
   // 乱数発生器
   std::mt19937 mRandGen;
 
+  // パタンの計算を行うオブジェクト
+  SimEngine mSimEngine;
+
+  // 初期パタン用の乱数の種
+  ymuint64 mRandSeed;
+
+  // SATソルバの種類
+  SatSolverType mSolverType;
+
   // SATソルバ
-  SatSolver mSolver;
+  // ガーベージコレクションの後や mRebuildInfo の条件を超えた時に作り直す．
+  unique_ptr<SatSolver> mSolver;
+
+  // 削除されたノードに割り当てられていた変数の数
+  int mDeadVarNum;
+
+  // 凍結した変数の数
+  int mFrozenNum;
+
+  // SAT ソルバの作り直しに関する情報
+  RebuildInfo mRebuildInfo;
+
+  // ポートフォリオに関する情報
+  PortfolioInfo mPortfolio;
+
+  // 直前の検査の反例(入力番号がインデックス)
+  // 反例を mSolver 以外(ポートフォリオや真理値表)で見つけた時のみ用いる．
+  vector<bool> mLastCex;
+
+  // 直前の検査の反例が mLastCex にある時 true にするフラグ
+  bool mLastCexValid;
+
+  // 各ノードのサポートの入力番号のリストを並べたもの
+  // FraigNode::mSupportPos が自分のリストの先頭を指す．
+  // 使われなくなったリストはガーベージコレクションの時に回収する．
+  vector<int> mSupportPool;
+
+  // 真理値表による検査の統計情報
+  SatStat mTruthTableInfo;
+
+  // 量化の統計情報
+  QuantifyInfo mQuantifyInfo;
 
   // SAT 用の割り当て格納配列
   SatModel mModel;
 
-  // sat_sweep 中のシミュレーション回数
+  // ランダムシミュレーションで追加したワード数
   int mSimCount;
 
-  // シミュレーションに要した時間
+  // ランダムシミュレーションに要した時間
   double mSimTime;
 
+  // クラスが分割されなかったランダムシミュレーションの連続回数
+  int mSimStreak;
+
   // check_const の統計情報
   SatStat mCheckConstInfo;
 
   // check_equiv の統計情報
   SatStat mCheckEquivInfo;
 
+  // sweep() の検査の統計情報
+  SatStat mSweepInfo;
+
+  // check_const の予算
+  SatLimit mCheckConstLimit;
+
+  // check_equiv の予算
+  SatLimit mCheckEquivLimit;
+
+  // sweep() の予算
+  SatLimit mSweepLimit;
+
+  // アボートした検査を再び行わない時 true にするフラグ
+  bool mSkipAborted;
+
+  // check_const でアボートした (ノード番号 * 2 + 極性) の集合
+  std::unordered_set<ymuint64> mConstAbortSet;
+
+  // check_equiv でアボートしたノード対のキーの集合
+  std::unordered_set<ymuint64> mEquivAbortSet;
+
+  // 等価検査にミタ回路を用いる時 true にするフラグ
+  bool mMiterCheck;
+
+  // 構築中は SAT を用いずに検査を sweep() にまとめる時 true にするフラグ
+  bool mBatchMode;
+
+  // バッチモードの sweep() の最初に加えるランダムパタンのワード数
+  int mBatchSimWords;
+
+  // バッチモードで作ったノードがまだ sweep() されていない時 true にするフラグ
+  bool mBatchPending;
+
+  // 無効化されていない活性化リテラルのリスト
+  vector<SatLiteral> mActLitList;
+
   // recsolver 用のストリーム
   ostream* mOutP;
 
@@ -351,12 +1021,28 @@ FraigMgrImpl::input_node(int pos) const
   return mInputNodes[pos];
 }
 
+// @brief 保留中の反例の有効なビットを表すマスクを返す．
+inline
+ymuint64
+FraigMgrImpl::cex_mask() const
+{
+  return mCexNum == 64 ? ~0ULL : (1ULL << mCexNum) - 1ULL;
+}
+
+// @brief 確定したパタン数を返す．
+inline
+int
+FraigMgrImpl::pat_used() const
+{
+  return mPatUsed;
+}
+
 // @brief ノード数を得る．
 inline
 int
 FraigMgrImpl::node_num() const
 {
-  return mAllNodes.size();
+  return mNodeNum;
 }
 
 // @brief ノードを取り出す．
@@ -368,7 +1054,58 @@ FraigMgrImpl::node(int pos) const
 {
   ASSERT_COND( pos >= 0 && pos < node_num() );
 
-  return mAllNodes[pos];
+  return mNodePageList[pos >> kPageBits] + (pos & kPageMask);
+}
+
+// @brief ファンインのノードを得る．
+inline
+FraigNode*
+FraigMgrImpl::fanin_node(FraigNode* node,
+			 int pos) const
+{
+  int id = node->fanin_id(pos);
+  return mNodePageList[id >> kPageBits] + (id & kPageMask);
+}
+
+// @brief ファンインのハンドルを得る．
+inline
+FraigHandle
+FraigMgrImpl::fanin_handle(FraigNode* node,
+			   int pos) const
+{
+  return FraigHandle::from_lit(node->fanin_lit(pos));
+}
+
+// @brief バッチモードの時 true を返す．
+inline
+bool
+FraigMgrImpl::batch_mode() const
+{
+  return mBatchMode;
+}
+
+// @brief バッチモードの sweep() の最初に加えるランダムパタンのワード数を返す．
+inline
+int
+FraigMgrImpl::batch_sim_words() const
+{
+  return mBatchSimWords;
+}
+
+// @brief ポートフォリオのソルバを競争させた回数を返す．
+inline
+int
+FraigMgrImpl::race_count() const
+{
+  return mPortfolio.mRaceCount;
+}
+
+// @brief ランダムシミュレーションで加えたパタンのワード数を返す．
+inline
+int
+FraigMgrImpl::sim_count() const
+{
+  return mSimCount;
 }
 
 END_NAMESPACE_FRAIG
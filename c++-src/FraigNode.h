@@ -11,6 +11,7 @@
 
 #include "ym/fraig.h"
 #include "ym/FraigHandle.h"
+#include "ym/SatLiteral.h"
 
 
 BEGIN_NAMESPACE_FRAIG
@@ -18,12 +19,18 @@ BEGIN_NAMESPACE_FRAIG
 //////////////////////////////////////////////////////////////////////
 /// @class FraigNode FraigNode.h "FraigNode.h"
 /// @brief Fraig のノードを表すクラス
+///
+/// ノードは FraigMgrImpl がページ単位でまとめて確保する．
+/// 他のノードはノード番号(ファンインの場合はノード番号 * 2 + 極性の
+/// リテラル番号)で参照するので，ノードの実体を得るには
+/// FraigMgrImpl::node() を用いる．
 //////////////////////////////////////////////////////////////////////
 class FraigNode
 {
   friend class FraigMgrImpl;
   friend class StructHash;
-  friend class PatHash;
+  friend class EqClassMgr;
+  friend class SimEngine;
 
 public:
 
@@ -56,8 +63,14 @@ public:
   // 変数番号に関するアクセス関数
   //////////////////////////////////////////////////////////////////////
 
+  /// @brief ノード番号を返す．
+  ///
+  /// シミュレーションパタンの行番号としても用いられる．
+  int
+  id() const;
+
   /// @brief CNF 上の変数番号を返す．
-  SatLiteral
+  SatVarId
   varid() const;
 
 
@@ -84,18 +97,25 @@ public:
   bool
   is_and() const;
 
-  /// @brief ファンインを得る．
+  /// @brief ファンインのリテラル番号を得る．
+  /// @param[in] pos 位置 ( 0 or 1 )
+  ///
+  /// ノード番号 * 2 + 極性の形で表す．
+  ymuint32
+  fanin_lit(int pos) const;
+
+  /// @brief ファンインのノード番号を得る．
   /// @param[in] pos 位置 ( 0 or 1 )
-  FraigNode*
-  fanin(int pos) const;
+  int
+  fanin_id(int pos) const;
 
-  /// @brief 1番めのファンインを得る．
-  FraigNode*
-  fanin0() const;
+  /// @brief 1番めのファンインのノード番号を得る．
+  int
+  fanin0_id() const;
 
-  /// @brief 2番めのファンインを得る．
-  FraigNode*
-  fanin1() const;
+  /// @brief 2番めのファンインのノード番号を得る．
+  int
+  fanin1_id() const;
 
   /// @brief ファンインの極性を得る．
   /// @param[in] pos 位置 ( 0 or 1 )
@@ -110,18 +130,11 @@ public:
   bool
   fanin1_inv() const;
 
-  /// @brief ファンインのハンドルを得る．
-  /// @param[in] pos 位置 ( 0 or 1 )
-  FraigHandle
-  fanin_handle(int pos) const;
-
-  /// @brief 1番め初のファンインのハンドルを得る．
-  FraigHandle
-  fanin0_handle() const;
-
-  /// @brief 2番めのファンインのハンドルを得る．
-  FraigHandle
-  fanin1_handle() const;
+  /// @brief サポート(ファンインコーンに含まれる入力)の数を返す．
+  ///
+  /// FraigMgrImpl が記録する上限を超えた場合は -1 を返す．
+  int
+  support_num() const;
 
 
 public:
@@ -129,22 +142,11 @@ public:
   // シミュレーション・パタンに関するアクセス関数
   //////////////////////////////////////////////////////////////////////
 
-  /// @brief パタンをセットする．
-  /// @param[in] start 開始位置
-  /// @param[in] end 終了位置
-  /// @param[in] pat パタンのベクタ
-  void
-  set_pat(int start,
-	  int end,
-	  const vector<ymuint64>& pat);
-
-  /// @brief パタンを計算する．
-  /// @param[in] start 開始位置
-  /// @param[in] end 終了位置
-  /// @note ANDノード用
-  void
-  calc_pat(int start,
-	   int end);
+  /// @brief 計算済みのパタン数を返す．
+  ///
+  /// 0 ワードめから sim_end() - 1 ワードめまでが計算済み
+  int
+  sim_end() const;
 
   /// @brief 0 の値を取るとき true を返す．
   bool
@@ -155,10 +157,17 @@ public:
   check_1mark() const;
 
   /// @brief パタンのハッシュ値を返す．
+  ///
+  /// 0 ワードめから sim_end() - 1 ワードめまでのパタンから計算される．
+  /// パタンは pat_hash_inv() で極性を正規化してから用いるので
+  /// 反転したパタンを持つノードも同じハッシュ値になる．
   SizeType
   pat_hash() const;
 
   /// @brief ハッシュ値の極性を返す．
+  ///
+  /// 0 ワードめの最下位ビットが 1 の時 true となる．
+  /// false の時はパタンを反転してからハッシュ値を計算する．
   bool
   pat_hash_inv() const;
 
@@ -172,14 +181,6 @@ public:
   bool
   check_dmark() const;
 
-  /// @brief 要素数が2以上の等価候補グループの代表なら true を返す．
-  bool
-  check_rep() const;
-
-  /// @brief 代表ノードを返す．
-  FraigNode*
-  rep_node() const;
-
   /// @brief 代表ノードに対する極性を返す．
   bool
   rep_inv() const;
@@ -188,37 +189,30 @@ public:
   FraigHandle
   rep_handle() const;
 
-  /// @brief 次の等価候補ノードを得る．
-  FraigNode*
-  next_eqnode();
-
-  /// @brief 等価候補の代表にする．
-  void
-  set_rep(FraigNode* rep_node,
-	  bool inv);
+  /// @brief 自分自身が代表ノードの時 true を返す．
+  ///
+  /// マージされたノードは false を返す．
+  bool
+  is_rep() const;
 
-  /// @brief 極性反転の印をつける．
-  void
-  set_rep_inv();
+  /// @brief 等価候補グループの番号を返す．
+  ///
+  /// グループに属していない場合は -1 を返す．
+  int
+  class_id() const;
 
-  /// @brief 等価候補ノードを追加する．
+  /// @brief 代表ノードをセットする．
+  /// @param[in] rep 代表ノードへのハンドル
+  ///
+  /// 定数に縮退した場合は定数のハンドルを渡す．
   void
-  add_eqnode(FraigNode* node);
+  set_rep(FraigHandle rep);
 
   /// @brief 削除済みの印をつける．
   void
   set_dmark();
 
 
-public:
-  //////////////////////////////////////////////////////////////////////
-  // ハッシュ用のリンクアクセス関数
-  //////////////////////////////////////////////////////////////////////
-
-  FraigNode*&
-  link(int link_pos);
-
-
 private:
   //////////////////////////////////////////////////////////////////////
   // 下請け関数
@@ -227,9 +221,22 @@ private:
   /// @brief ハッシュ値を計算する．
   /// @param[in] start 開始位置
   /// @param[in] end 終了位置
+  /// @param[in] src start から end - 1 までのパタンを収めた領域
+  ///
+  /// 各ワードの寄与の XOR を取るので追加したワード数に比例する
+  /// 時間でハッシュ値を更新できる．
   void
   calc_hash(int start,
-	    int end);
+	    int end,
+	    const ymuint64* src);
+
+  /// @brief 1ワード分のハッシュ値の寄与を返す．
+  /// @param[in] pat 極性を正規化したパタン
+  /// @param[in] pos ワード位置
+  static
+  ymuint64
+  word_hash(ymuint64 pat,
+	    int pos);
 
   /// @brief 0 の値を取ったことを記録する．
   void
@@ -239,51 +246,87 @@ private:
   void
   set_1mark();
 
+  /// @brief CNF が読み込まれている時 true を返す．
+  ///
+  /// 読み込まれていない時は varid() は意味を持たない．
+  bool
+  is_loaded() const;
+
+  /// @brief CNF が読み込まれた印をつける．
+  void
+  set_loaded();
+
+  /// @brief CNF 読み込み済みの印を消す．
+  ///
+  /// 変数番号と凍結済みの印も無効にする．
+  void
+  clear_loaded();
+
+  /// @brief 変数が凍結されている時 true を返す．
+  ///
+  /// 凍結されていない変数は SAT ソルバの前処理で除去される可能性がある．
+  bool
+  is_frozen() const;
+
+  /// @brief 変数が凍結された印をつける．
+  void
+  set_frozen();
+
+  /// @brief 作業用のマークを返す．
+  bool
+  check_tmark() const;
+
+  /// @brief 作業用のマークをつける．
+  void
+  set_tmark();
+
+  /// @brief 作業用のマークを消す．
+  void
+  clear_tmark();
+
 
 private:
   //////////////////////////////////////////////////////////////////////
   // データメンバ
   //////////////////////////////////////////////////////////////////////
 
-  // CNF 上の変数番号
-  SatLiteral mVarId;
-
-  // ファンインのノード
-  FraigNode* mFanins[2];
+  // パディングが入らないように 8 バイトのメンバを先に置く．
 
-  // 0/1マーク，極性などの情報をパックしたもの
-  ymuint32 mFlags;
+  // シミュレーションパタンのハッシュ値
+  SizeType mHash;
 
-  // シミュレーションパタン
-  ymuint64* mPat;
+  // 代表ノードのリテラル番号
+  ymuint32 mRepLit;
 
-  // mPat のハッシュ値
-  SizeType mHash;
+  // ノード番号
+  int mId;
 
-  // 構造ハッシュ用のリンクポインタ
-  FraigNode* mLink1;
+  // CNF 上の変数番号
+  SatVarId mVarId;
 
-  // シグネチャハッシュ用のリンクポインタ
-  FraigNode* mLink2;
+  // ファンインのリテラル番号
+  // 入力ノードの場合は mFanins[0] に入力番号を入れる．
+  ymuint32 mFanins[2];
 
-  // 代表ノード情報
-  FraigNode* mRepNode;
+  // 0/1マーク，極性などの情報をパックしたもの
+  ymuint32 mFlags;
 
-  // 次の等価候補ノード
-  FraigNode* mEqLink;
+  // 計算済みのパタン数
+  int mSimEnd;
 
-  // 等価候補リストの末尾のノード
-  FraigNode* mEqTail;
+  // 保留中の反例のワードを計算した時のスタンプ
+  ymuint32 mCexStamp;
 
+  // 等価候補グループの番号
+  int mClassId;
 
-private:
-  //////////////////////////////////////////////////////////////////////
-  // クラスメンバ
-  //////////////////////////////////////////////////////////////////////
+  // サポートの入力番号のリストの FraigMgrImpl::mSupportPool 上の位置
+  // サポートが上限を超えた場合は -1
+  int mSupportPos;
 
-  // ハッシュ用の素数配列
-  static
-  ymuint64 mPrimes[];
+  // サポートの数
+  // サポートが上限を超えた場合は -1
+  int mSupportNum;
 
 
 private:
@@ -295,33 +338,33 @@ private:
   static
   const int kSftI  = 0;
 
-  // ファンイン0 の極性
+  // 0 になったことがあるかどうか
   static
-  const int kSftP0 = 1;
+  const int kSft0  = 1;
 
-  // ファンイン1 の極性
+  // 1 になったことがあるかどうか
   static
-  const int kSftP1 = 2;
+  const int kSft1  = 2;
 
-  // 0 になったことがあるかどうか
+  // ハッシュパタンの極性
   static
-  const int kSft0  = 3;
+  const int kSftH  = 3;
 
-  // 1 になったことがあるかどうか
+  // 削除マーク
   static
-  const int kSft1  = 4;
+  const int kSftD  = 4;
 
-  // ハッシュパタンの極性
+  // 作業用のマーク
   static
-  const int kSftH  = 5;
+  const int kSftT  = 5;
 
-  // 等価グループ中の極性
+  // CNF 読み込み済みマーク
   static
-  const int kSftP  = 6;
+  const int kSftL  = 6;
 
-  // 削除マーク
+  // 変数の凍結済みマーク
   static
-  const int kSftD  = 7;
+  const int kSftF  = 7;
 
 };
 
@@ -330,9 +373,17 @@ private:
 // インライン関数の定義
 //////////////////////////////////////////////////////////////////////
 
+// @brief ノード番号を返す．
+inline
+int
+FraigNode::id() const
+{
+  return mId;
+}
+
 // @brief CNF 上の変数番号を返す．
 inline
-SatLiteral
+SatVarId
 FraigNode::varid() const
 {
   return mVarId;
@@ -351,7 +402,7 @@ inline
 int
 FraigNode::input_id() const
 {
-  return reinterpret_cast<ympuint>(mFanins[0]);
+  return mFanins[0];
 }
 
 // @brief 入力番号をセットする．
@@ -360,7 +411,7 @@ void
 FraigNode::set_input(int id)
 {
   mFlags |= (1U << kSftI);
-  mFanins[0] = reinterpret_cast<FraigNode*>(id);
+  mFanins[0] = id;
 }
 
 // @brief AND の時に true を返す．
@@ -371,30 +422,38 @@ FraigNode::is_and() const
   return !is_input();
 }
 
-// @brief ファンインを得る．
+// @brief ファンインのリテラル番号を得る．
 inline
-FraigNode*
-FraigNode::fanin(int pos) const
+ymuint32
+FraigNode::fanin_lit(int pos) const
 {
   // 安全のため pos の値を補正しておく．
   pos &= 1;
   return mFanins[pos];
 }
 
-// @brief 最初のファンインを得る．
+// @brief ファンインのノード番号を得る．
 inline
-FraigNode*
-FraigNode::fanin0() const
+int
+FraigNode::fanin_id(int pos) const
 {
-  return mFanins[0];
+  return fanin_lit(pos) >> 1;
+}
+
+// @brief 最初のファンインのノード番号を得る．
+inline
+int
+FraigNode::fanin0_id() const
+{
+  return mFanins[0] >> 1;
 }
 
-// @brief 2番めのファンインを得る．
+// @brief 2番めのファンインのノード番号を得る．
 inline
-FraigNode*
-FraigNode::fanin1() const
+int
+FraigNode::fanin1_id() const
 {
-  return mFanins[1];
+  return mFanins[1] >> 1;
 }
 
 // @brief ファンインの極性を得る．
@@ -402,9 +461,7 @@ inline
 bool
 FraigNode::fanin_inv(int pos) const
 {
-  // 安全のため pos の値を補正しておく．
-  pos &= 1;
-  return static_cast<bool>((mFlags >> (kSftP0 + pos)) & 1U);
+  return static_cast<bool>(fanin_lit(pos) & 1U);
 }
 
 // @brief 最初のファンインの極性を得る．
@@ -412,7 +469,7 @@ inline
 bool
 FraigNode::fanin0_inv() const
 {
-  return static_cast<bool>((mFlags >> kSftP0) & 1U);
+  return static_cast<bool>(mFanins[0] & 1U);
 }
 
 // @brief 2番めのファンインの極性を得る．
@@ -420,33 +477,23 @@ inline
 bool
 FraigNode::fanin1_inv() const
 {
-  return static_cast<bool>((mFlags >> kSftP1) & 1U);
-}
-
-// @brief ファンインのハンドルを得る．
-inline
-FraigHandle
-FraigNode::fanin_handle(int pos) const
-{
-  // 安全のため pos の値を補正しておく．
-  pos &= 1;
-  return FraigHandle(fanin(pos), fanin_inv(pos));
+  return static_cast<bool>(mFanins[1] & 1U);
 }
 
-// @brief 最初のファンインのハンドルを得る．
+// @brief サポート(ファンインコーンに含まれる入力)の数を返す．
 inline
-FraigHandle
-FraigNode::fanin0_handle() const
+int
+FraigNode::support_num() const
 {
-  return FraigHandle(fanin0(), fanin0_inv());
+  return mSupportNum;
 }
 
-// @brief 2番めのファンインのハンドルを得る．
+// @brief 計算済みのパタン数を返す．
 inline
-FraigHandle
-FraigNode::fanin1_handle() const
+int
+FraigNode::sim_end() const
 {
-  return FraigHandle(fanin1(), fanin1_inv());
+  return mSimEnd;
 }
 
 // @brief 0 の値を取るとき true を返す．
@@ -481,28 +528,32 @@ FraigNode::pat_hash_inv() const
   return static_cast<bool>((mFlags >> kSftH) & 1U);
 }
 
-// @brief 削除済みのとき true を返す．
+// @brief 1ワード分のハッシュ値の寄与を返す．
+// @param[in] pat 極性を正規化したパタン
+// @param[in] pos ワード位置
 inline
-bool
-FraigNode::check_dmark() const
+ymuint64
+FraigNode::word_hash(ymuint64 pat,
+		     int pos)
 {
-  return static_cast<bool>((mFlags >> kSftD) & 1U);
+  // ワード位置ごとに異なる定数を混ぜてから
+  // MurmurHash3 の fmix64 で全ビットを攪拌する．
+  // 位置の数に上限はない．
+  ymuint64 x = pat ^ ((static_cast<ymuint64>(pos) + 1) * 0x9E3779B97F4A7C15ULL);
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x;
 }
 
-// @brief 要素数が2以上の等価候補グループの代表なら true を返す．
+// @brief 削除済みのとき true を返す．
 inline
 bool
-FraigNode::check_rep() const
-{
-  return mRepNode == this && mEqLink != nullptr;
-}
-
-// @brief 代表ノードを返す．
-inline
-FraigNode*
-FraigNode::rep_node() const
+FraigNode::check_dmark() const
 {
-  return mRepNode;
+  return static_cast<bool>((mFlags >> kSftD) & 1U);
 }
 
 // @brief 代表ノードに対する極性を返す．
@@ -510,7 +561,7 @@ inline
 bool
 FraigNode::rep_inv() const
 {
-  return static_cast<bool>((mFlags >> kSftP) & 1U);
+  return static_cast<bool>(mRepLit & 1U);
 }
 
 // @brief 代表ノードを返す．
@@ -518,38 +569,31 @@ inline
 FraigHandle
 FraigNode::rep_handle() const
 {
-  return FraigHandle(mRepNode, rep_inv());
+  return FraigHandle::from_lit(mRepLit);
 }
 
-// @brief 次の等価候補ノードを得る．
+// @brief 自分自身が代表ノードの時 true を返す．
 inline
-FraigNode*
-FraigNode::next_eqnode()
+bool
+FraigNode::is_rep() const
 {
-  return mEqLink;
+  return mRepLit == static_cast<ymuint32>(mId) * 2;
 }
 
-// @brief 代表ノードをセットする．
+// @brief 等価候補グループの番号を返す．
 inline
-void
-FraigNode::set_rep(FraigNode* rep_node,
-		   bool inv)
+int
+FraigNode::class_id() const
 {
-  mRepNode = rep_node;
-  if ( inv ) {
-    set_rep_inv();
-  }
+  return mClassId;
 }
 
-// @brief 等価候補ノードを追加する．
+// @brief 代表ノードをセットする．
 inline
 void
-FraigNode::add_eqnode(FraigNode* node)
+FraigNode::set_rep(FraigHandle rep)
 {
-  mEqTail->mEqLink = node;
-  mEqTail = node;
-  node->mRepNode = this;
-  node->mEqLink = nullptr;
+  mRepLit = rep.lit();
 }
 
 // @brief 0 の値を取ったことを記録する．
@@ -568,64 +612,77 @@ FraigNode::set_1mark()
   mFlags |= (1U << kSft1);
 }
 
-// @brief 極性反転の印をつける．
+// @brief CNF が読み込まれている時 true を返す．
+inline
+bool
+FraigNode::is_loaded() const
+{
+  return static_cast<bool>((mFlags >> kSftL) & 1U);
+}
+
+// @brief CNF が読み込まれた印をつける．
 inline
 void
-FraigNode::set_rep_inv()
+FraigNode::set_loaded()
 {
-  mFlags |= (1U << kSftP);
+  mFlags |= (1U << kSftL);
 }
 
-// @brief 削除済みの印をつける．
+// @brief CNF 読み込み済みの印を消す．
 inline
 void
-FraigNode::set_dmark()
+FraigNode::clear_loaded()
 {
-  mFlags |= (1U << kSftD);
+  mFlags &= ~((1U << kSftL) | (1U << kSftF));
+  mVarId = SatVarId();
 }
 
-// @brief パタンを計算する．
+// @brief 変数が凍結されている時 true を返す．
+inline
+bool
+FraigNode::is_frozen() const
+{
+  return static_cast<bool>((mFlags >> kSftF) & 1U);
+}
+
+// @brief 変数が凍結された印をつける．
 inline
 void
-FraigNode::calc_pat(int start,
-		    int end)
-{
-  ymuint64* dst = mPat + start;
-  ymuint64* dst_end = mPat + end;
-  ymuint64* src1 = mFanins[0]->mPat + start;
-  ymuint64* src2 = mFanins[1]->mPat + start;
-  if ( fanin0_inv() ) {
-    if ( fanin1_inv() ) {
-      for ( ; dst != dst_end; ++ dst, ++src1, ++src2) {
-	*dst = ~(*src1 | *src2);
-      }
-    }
-    else {
-      for ( ; dst != dst_end; ++ dst, ++src1, ++src2) {
-	*dst = ~*src1 & *src2;
-      }
-    }
-  }
-  else {
-    if ( fanin1_inv() ) {
-      for ( ; dst != dst_end; ++ dst, ++src1, ++src2) {
-	*dst = *src1 & ~*src2;
-      }
-    }
-    else {
-      for ( ; dst != dst_end; ++ dst, ++src1, ++src2) {
-	*dst = *src1 & *src2;
-      }
-    }
-  }
-  calc_hash(start, end);
-}
-
-inline
-FraigNode*&
-FraigNode::link(int link_pos)
-{
-  return link_pos == 0 ? mLink1 : mLink2;
+FraigNode::set_frozen()
+{
+  mFlags |= (1U << kSftF);
+}
+
+// @brief 作業用のマークを返す．
+inline
+bool
+FraigNode::check_tmark() const
+{
+  return static_cast<bool>((mFlags >> kSftT) & 1U);
+}
+
+// @brief 作業用のマークをつける．
+inline
+void
+FraigNode::set_tmark()
+{
+  mFlags |= (1U << kSftT);
+}
+
+// @brief 作業用のマークを消す．
+inline
+void
+FraigNode::clear_tmark()
+{
+  mFlags &= ~(1U << kSftT);
+}
+
+// @brief 削除済みの印をつける．
+inline
+void
+FraigNode::set_dmark()
+{
+  mFlags |= (1U << kSftD);
 }
 
 END_NAMESPACE_FRAIG
@@ -0,0 +1,123 @@
+﻿
+/// @file PatMgr.cc
+/// @brief PatMgr の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "PatMgr.h"
+
+
+BEGIN_NAMESPACE_FRAIG
+
+//////////////////////////////////////////////////////////////////////
+// PatMgr
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+PatMgr::PatMgr() :
+  mNodeNum(0),
+  mBlockNum(0)
+{
+}
+
+// @brief デストラクタ
+PatMgr::~PatMgr()
+{
+  for ( auto& tile_list: mTileArray ) {
+    for ( auto tile: tile_list ) {
+      delete [] tile;
+    }
+  }
+}
+
+// @brief ノードを一つ追加する．
+// @return 追加されたノードの番号を返す．
+int
+PatMgr::add_node()
+{
+  int id = mNodeNum;
+  if ( id % kNodeChunk == 0 ) {
+    // 新しいノードチャンクのタイルを確保する．
+    mTileArray.push_back(vector<ymuint64*>(mBlockNum));
+    auto& tile_list = mTileArray.back();
+    for ( int b = 0; b < mBlockNum; ++ b ) {
+      tile_list[b] = new_tile();
+    }
+  }
+  ++ mNodeNum;
+  return id;
+}
+
+// @brief 確保するワード数を設定する．
+// @param[in] size ワード数
+//
+// 現在のサイズより小さい場合にはなにもしない．
+void
+PatMgr::reserve(int size)
+{
+  int req_num = (size + kBlockSize - 1) / kBlockSize;
+  if ( req_num <= mBlockNum ) {
+    return;
+  }
+
+  // 全てのノードチャンクに新しいブロックのタイルを追加する．
+  for ( auto& tile_list: mTileArray ) {
+    for ( int b = mBlockNum; b < req_num; ++ b ) {
+      tile_list.push_back(new_tile());
+    }
+  }
+  mBlockNum = req_num;
+}
+
+// @brief ノードのパタンをコピーする．
+// @param[in] dst コピー先のノード番号
+// @param[in] src コピー元のノード番号
+// @param[in] end コピーするワード数 ( end <= capacity() )
+void
+PatMgr::copy_node(int dst,
+		  int src,
+		  int end)
+{
+  ASSERT_COND( end <= capacity() );
+
+  for ( int b = 0; b * kBlockSize < end; ++ b ) {
+    int n = std::min(end - b * kBlockSize, kBlockSize);
+    const ymuint64* src_block = block(src, b);
+    ymuint64* dst_block = block(dst, b);
+    for ( int i = 0; i < n; ++ i ) {
+      dst_block[i] = src_block[i];
+    }
+  }
+}
+
+// @brief ノード数を減らす．
+// @param[in] num 新しいノード数 ( num <= node_num() )
+//
+// 使われなくなったタイルは解放する．
+void
+PatMgr::shrink(int num)
+{
+  ASSERT_COND( num <= mNodeNum );
+
+  int chunk_num = (num + kNodeChunk - 1) / kNodeChunk;
+  int old_chunk_num = mTileArray.size();
+  for ( int c = chunk_num; c < old_chunk_num; ++ c ) {
+    for ( auto tile: mTileArray[c] ) {
+      delete [] tile;
+    }
+  }
+  mTileArray.resize(chunk_num);
+  mNodeNum = num;
+}
+
+// @brief タイルを確保する．
+ymuint64*
+PatMgr::new_tile()
+{
+  return new ymuint64[kNodeChunk * kBlockSize];
+}
+
+END_NAMESPACE_FRAIG
@@ -0,0 +1,215 @@
+﻿#ifndef PATMGR_H
+#define PATMGR_H
+
+/// @file PatMgr.h
+/// @brief PatMgr のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "ym/fraig.h"
+
+
+BEGIN_NAMESPACE_FRAIG
+
+//////////////////////////////////////////////////////////////////////
+/// @class PatMgr PatMgr.h "PatMgr.h"
+/// @brief 全ノードのシミュレーションパタンをまとめて管理するクラス
+///
+/// パタンは (ノード番号, ワード位置) の2次元の行列として持つ．
+/// 行列は kNodeChunk ノード x kBlockSize ワードのタイルに分割されており，
+/// ノード数が増えた時もワード数が増えた時もタイルを追加するだけで
+/// 既存のパタンのコピーは行わない．
+/// タイルの中ではノードごとに kBlockSize ワードが連続して並ぶので
+/// 1つのノードのパタンはブロック単位で連続領域として参照できる．
+//////////////////////////////////////////////////////////////////////
+class PatMgr
+{
+public:
+
+  /// @brief 1つのタイルに含まれるワード数
+  static
+  const int kBlockSize = 64;
+
+  /// @brief 1つのタイルに含まれるノード数
+  static
+  const int kNodeChunk = 256;
+
+
+public:
+
+  /// @brief コンストラクタ
+  PatMgr();
+
+  /// @brief デストラクタ
+  ~PatMgr();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief ノード数を返す．
+  int
+  node_num() const;
+
+  /// @brief 確保されているワード数を返す．
+  int
+  capacity() const;
+
+  /// @brief ノードを一つ追加する．
+  /// @return 追加されたノードの番号を返す．
+  int
+  add_node();
+
+  /// @brief 確保するワード数を設定する．
+  /// @param[in] size ワード数
+  ///
+  /// 現在のサイズより小さい場合にはなにもしない．
+  void
+  reserve(int size);
+
+  /// @brief ノードのパタンをコピーする．
+  /// @param[in] dst コピー先のノード番号
+  /// @param[in] src コピー元のノード番号
+  /// @param[in] end コピーするワード数 ( end <= capacity() )
+  void
+  copy_node(int dst,
+	    int src,
+	    int end);
+
+  /// @brief ノード数を減らす．
+  /// @param[in] num 新しいノード数 ( num <= node_num() )
+  ///
+  /// 使われなくなったタイルは解放する．
+  void
+  shrink(int num);
+
+  /// @brief ブロックの先頭を返す．
+  /// @param[in] id ノード番号 ( 0 <= id < node_num() )
+  /// @param[in] block ブロック番号 ( 0 <= block < capacity() / kBlockSize )
+  ///
+  /// 返り値から kBlockSize ワードが連続して並んでいる．
+  ymuint64*
+  block(int id,
+	int block);
+
+  /// @brief ブロックの先頭を返す．
+  /// @param[in] id ノード番号 ( 0 <= id < node_num() )
+  /// @param[in] block ブロック番号 ( 0 <= block < capacity() / kBlockSize )
+  const ymuint64*
+  block(int id,
+	int block) const;
+
+  /// @brief 1ワード分のパタンを返す．
+  /// @param[in] id ノード番号 ( 0 <= id < node_num() )
+  /// @param[in] pos ワード位置 ( 0 <= pos < capacity() )
+  ymuint64&
+  word(int id,
+       int pos);
+
+  /// @brief 1ワード分のパタンを返す．
+  /// @param[in] id ノード番号 ( 0 <= id < node_num() )
+  /// @param[in] pos ワード位置 ( 0 <= pos < capacity() )
+  ymuint64
+  word(int id,
+       int pos) const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief タイルを確保する．
+  static
+  ymuint64*
+  new_tile();
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // ノード数
+  int mNodeNum;
+
+  // ブロック数
+  int mBlockNum;
+
+  // タイルの配列
+  // mTileArray[ノード番号 / kNodeChunk][ブロック番号] で参照する．
+  vector<vector<ymuint64*>> mTileArray;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief ノード数を返す．
+inline
+int
+PatMgr::node_num() const
+{
+  return mNodeNum;
+}
+
+// @brief 確保されているワード数を返す．
+inline
+int
+PatMgr::capacity() const
+{
+  return mBlockNum * kBlockSize;
+}
+
+// @brief ブロックの先頭を返す．
+inline
+ymuint64*
+PatMgr::block(int id,
+	      int block)
+{
+  ASSERT_COND( id >= 0 && id < mNodeNum );
+  ASSERT_COND( block >= 0 && block < mBlockNum );
+
+  return mTileArray[id / kNodeChunk][block] + (id % kNodeChunk) * kBlockSize;
+}
+
+// @brief ブロックの先頭を返す．
+inline
+const ymuint64*
+PatMgr::block(int id,
+	      int block) const
+{
+  ASSERT_COND( id >= 0 && id < mNodeNum );
+  ASSERT_COND( block >= 0 && block < mBlockNum );
+
+  return mTileArray[id / kNodeChunk][block] + (id % kNodeChunk) * kBlockSize;
+}
+
+// @brief 1ワード分のパタンを返す．
+inline
+ymuint64&
+PatMgr::word(int id,
+	     int pos)
+{
+  return block(id, pos / kBlockSize)[pos % kBlockSize];
+}
+
+// @brief 1ワード分のパタンを返す．
+inline
+ymuint64
+PatMgr::word(int id,
+	     int pos) const
+{
+  return block(id, pos / kBlockSize)[pos % kBlockSize];
+}
+
+END_NAMESPACE_FRAIG
+
+#endif // PATMGR_H
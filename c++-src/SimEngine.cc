@@ -0,0 +1,283 @@
+﻿
+/// @file SimEngine.cc
+/// @brief SimEngine の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "SimEngine.h"
+#include "FraigNode.h"
+#include "PatMgr.h"
+#include "SimKernel.h"
+
+
+BEGIN_NAMESPACE_FRAIG
+
+BEGIN_NONAMESPACE
+
+// 1スレッドあたりの仕事量(ワード数)の下限
+// これより小さい仕事はスレッドを起こす手間の方が大きい．
+const SizeType kMinWork = 1 << 16;
+
+END_NONAMESPACE
+
+//////////////////////////////////////////////////////////////////////
+// クラス SimEngine
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+// @param[in] pat_mgr パタンを格納するオブジェクト
+SimEngine::SimEngine(PatMgr& pat_mgr) :
+  mPatMgr(pat_mgr),
+  mJob(nullptr),
+  mJobNum(0),
+  mGeneration(0),
+  mRemain(0),
+  mQuit(false)
+{
+}
+
+// @brief デストラクタ
+SimEngine::~SimEngine()
+{
+  stop_workers();
+}
+
+// @brief スレッド数を設定する．
+// @param[in] num スレッド数
+void
+SimEngine::set_thread_num(int num)
+{
+  if ( num < 1 ) {
+    num = 1;
+  }
+  if ( num == thread_num() ) {
+    return;
+  }
+
+  stop_workers();
+
+  mQuit = false;
+  for ( int tid = 1; tid < num; ++ tid ) {
+    int generation = mGeneration;
+    mWorkerList.push_back(std::thread([this, tid, generation]() {
+	  worker(tid, generation);
+	}));
+  }
+}
+
+// @brief 入力ノードに乱数パタンをセットする．
+// @param[in] node 対象のノード
+// @param[in] start 開始位置
+// @param[in] end 終了位置
+// @param[in] seed 乱数の種
+void
+SimEngine::set_random(FraigNode* node,
+		      int start,
+		      int end,
+		      ymuint64 seed)
+{
+  if ( start >= end ) {
+    return;
+  }
+
+  const int kBlockSize = PatMgr::kBlockSize;
+  int id = node->id();
+  int bs = start / kBlockSize;
+  int nb = (end - 1) / kBlockSize + 1 - bs;
+  int n = split_num(end - start, nb);
+  run(n, [&](int k) {
+      int b0 = bs + nb * k / n;
+      int b1 = bs + nb * (k + 1) / n;
+      for ( int b = b0; b < b1; ++ b ) {
+	int offset = b * kBlockSize;
+	int s = std::max(start, offset);
+	int e = std::min(end, offset + kBlockSize);
+	ymuint64* dst = mPatMgr.block(id, b) + (s - offset);
+	for ( int pos = s; pos < e; ++ pos ) {
+	  dst[pos - s] = random_word(seed, id, pos);
+	}
+      }
+    });
+
+  for ( int b = bs; b < bs + nb; ++ b ) {
+    int offset = b * kBlockSize;
+    int s = std::max(start, offset);
+    int e = std::min(end, offset + kBlockSize);
+    node->calc_hash(s, e, mPatMgr.block(id, b) + (s - offset));
+  }
+  node->mSimEnd = end;
+}
+
+// @brief AND ノードのパタンを計算する．
+// @param[in] node_list 対象のノードのリスト
+// @param[in] end 終了位置
+void
+SimEngine::calc_pat(const vector<FraigNode*>& node_list,
+		    int end)
+{
+  if ( node_list.empty() ) {
+    return;
+  }
+
+  const int kBlockSize = PatMgr::kBlockSize;
+  int start = end;
+  for ( auto node: node_list ) {
+    ASSERT_COND( node->is_and() );
+    start = std::min(start, node->sim_end());
+  }
+  if ( start >= end ) {
+    return;
+  }
+
+  // 1. ワードの範囲をブロック単位で分割してパタンを計算する．
+  //    各スレッドが書き込むタイルは互いに素になる．
+  int bs = start / kBlockSize;
+  int nb = (end - 1) / kBlockSize + 1 - bs;
+  SizeType work = static_cast<SizeType>(node_list.size()) * (end - start);
+  int n1 = split_num(work, nb);
+  run(n1, [&](int k) {
+      int b0 = bs + nb * k / n1;
+      int b1 = bs + nb * (k + 1) / n1;
+      int s0 = std::max(start, b0 * kBlockSize);
+      int e0 = std::min(end, b1 * kBlockSize);
+      for ( auto node: node_list ) {
+	int id = node->id();
+	int id0 = node->fanin0_id();
+	int id1 = node->fanin1_id();
+	bool inv0 = node->fanin0_inv();
+	bool inv1 = node->fanin1_inv();
+	int s1 = std::max(s0, node->sim_end());
+	for ( int b = s1 / kBlockSize; b * kBlockSize < e0; ++ b ) {
+	  int offset = b * kBlockSize;
+	  int s = std::max(s1, offset);
+	  int e = std::min(e0, offset + kBlockSize);
+	  ymuint64* dst = mPatMgr.block(id, b) + (s - offset);
+	  const ymuint64* src0 = mPatMgr.block(id0, b) + (s - offset);
+	  const ymuint64* src1 = mPatMgr.block(id1, b) + (s - offset);
+	  SimKernel::and_pat(dst, src0, src1, e - s, inv0, inv1);
+	}
+      }
+    });
+
+  // 2. ノードの範囲を分割してハッシュ値を計算する．
+  //    ハッシュ値は各ワードの寄与の XOR なので計算順によらない．
+  int nn = node_list.size();
+  int n2 = split_num(work, nn);
+  run(n2, [&](int k) {
+      int i0 = nn * k / n2;
+      int i1 = nn * (k + 1) / n2;
+      for ( int i = i0; i < i1; ++ i ) {
+	FraigNode* node = node_list[i];
+	int id = node->id();
+	int s1 = node->sim_end();
+	for ( int b = s1 / kBlockSize; b * kBlockSize < end; ++ b ) {
+	  int offset = b * kBlockSize;
+	  int s = std::max(s1, offset);
+	  int e = std::min(end, offset + kBlockSize);
+	  node->calc_hash(s, e, mPatMgr.block(id, b) + (s - offset));
+	}
+	node->mSimEnd = end;
+      }
+    });
+}
+
+// @brief 並列に計算する時の分割数を求める．
+// @param[in] work 仕事量(ノード数 x ワード数)
+// @param[in] max_num 分割数の上限
+int
+SimEngine::split_num(SizeType work,
+		     int max_num) const
+{
+  SizeType n = work / kMinWork;
+  if ( n > static_cast<SizeType>(thread_num()) ) {
+    n = thread_num();
+  }
+  if ( n > static_cast<SizeType>(max_num) ) {
+    n = max_num;
+  }
+  return n < 1 ? 1 : n;
+}
+
+// @brief job(0) から job(n - 1) を並列に実行する．
+// @param[in] n ジョブ数 ( n <= thread_num() )
+// @param[in] job ジョブ
+void
+SimEngine::run(int n,
+	       const std::function<void(int)>& job)
+{
+  ASSERT_COND( n <= thread_num() );
+
+  if ( n <= 1 ) {
+    job(0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mJob = &job;
+    mJobNum = n;
+    mRemain = mWorkerList.size();
+    ++ mGeneration;
+  }
+  mStartCond.notify_all();
+
+  job(0);
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  mDoneCond.wait(lock, [this]() { return mRemain == 0; });
+  mJob = nullptr;
+}
+
+// @brief ワーカースレッドの本体
+// @param[in] tid スレッド番号 ( 1 <= tid < thread_num() )
+// @param[in] generation 起動時のジョブの番号
+void
+SimEngine::worker(int tid,
+		  int generation)
+{
+  for ( ; ; ) {
+    const std::function<void(int)>* job;
+    int n;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mStartCond.wait(lock, [this, generation]() {
+	  return mQuit || mGeneration != generation;
+	});
+      if ( mQuit ) {
+	return;
+      }
+      generation = mGeneration;
+      job = mJob;
+      n = mJobNum;
+    }
+
+    if ( tid < n ) {
+      (*job)(tid);
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if ( -- mRemain == 0 ) {
+      mDoneCond.notify_one();
+    }
+  }
+}
+
+// @brief ワーカースレッドを終了させる．
+void
+SimEngine::stop_workers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mQuit = true;
+  }
+  mStartCond.notify_all();
+  for ( auto& th: mWorkerList ) {
+    th.join();
+  }
+  mWorkerList.clear();
+}
+
+END_NAMESPACE_FRAIG
@@ -0,0 +1,204 @@
+﻿#ifndef SIMENGINE_H
+#define SIMENGINE_H
+
+/// @file SimEngine.h
+/// @brief SimEngine のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "ym/fraig.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+BEGIN_NAMESPACE_FRAIG
+
+class FraigNode;
+class PatMgr;
+
+//////////////////////////////////////////////////////////////////////
+/// @class SimEngine SimEngine.h "SimEngine.h"
+/// @brief パタンの計算をスレッドに分割して行うクラス
+///
+/// パタンの計算はワード位置ごとに独立なので，ワードの範囲を
+/// ブロック境界で分割して各スレッドに割り当てる．
+/// 各スレッドは自分の範囲について全ノードをトポロジカル順に計算する．
+/// ハッシュ値の計算は全パタンの計算が終わった後で
+/// ノードの範囲を分割して行う．
+/// どちらもスレッド数によらず逐次版と同じ結果になる．
+//////////////////////////////////////////////////////////////////////
+class SimEngine
+{
+public:
+
+  /// @brief コンストラクタ
+  /// @param[in] pat_mgr パタンを格納するオブジェクト
+  SimEngine(PatMgr& pat_mgr);
+
+  /// @brief デストラクタ
+  ~SimEngine();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief スレッド数を返す．
+  int
+  thread_num() const;
+
+  /// @brief スレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// 1 以下の場合は呼び出したスレッドのみで計算する．
+  void
+  set_thread_num(int num);
+
+  /// @brief 入力ノードに乱数パタンをセットする．
+  /// @param[in] node 対象のノード
+  /// @param[in] start 開始位置
+  /// @param[in] end 終了位置
+  /// @param[in] seed 乱数の種
+  ///
+  /// 各ワードの値は (seed, ノード番号, ワード位置) のみから決まる．
+  void
+  set_random(FraigNode* node,
+	     int start,
+	     int end,
+	     ymuint64 seed);
+
+  /// @brief AND ノードのパタンを計算する．
+  /// @param[in] node_list 対象のノードのリスト
+  /// @param[in] end 終了位置
+  ///
+  /// node_list はノード番号の昇順に並んでいなければならない．
+  /// 各ノードは sim_end() ワードめから end - 1 ワードめまで計算される．
+  /// node_list に含まれないファンインは end まで計算済みでなければならない．
+  void
+  calc_pat(const vector<FraigNode*>& node_list,
+	   int end);
+
+  /// @brief 乱数パタンの1ワードを返す．
+  /// @param[in] seed 乱数の種
+  /// @param[in] id ノード番号
+  /// @param[in] pos ワード位置
+  static
+  ymuint64
+  random_word(ymuint64 seed,
+	      int id,
+	      int pos);
+
+  /// @brief job(0) から job(n - 1) を並列に実行する．
+  /// @param[in] n ジョブ数 ( n <= thread_num() )
+  /// @param[in] job ジョブ
+  ///
+  /// job(0) は呼び出したスレッドで実行する．
+  /// 全てのジョブが終わるまで戻らない．
+  /// パタンの計算以外の仕事(ポートフォリオなど)にも用いる．
+  void
+  run(int n,
+      const std::function<void(int)>& job);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 並列に計算する時の分割数を求める．
+  /// @param[in] work 仕事量(ノード数 x ワード数)
+  /// @param[in] max_num 分割数の上限
+  int
+  split_num(SizeType work,
+	    int max_num) const;
+
+  /// @brief ワーカースレッドの本体
+  /// @param[in] tid スレッド番号 ( 1 <= tid < thread_num() )
+  /// @param[in] generation 起動時のジョブの番号
+  void
+  worker(int tid,
+	 int generation);
+
+  /// @brief ワーカースレッドを終了させる．
+  void
+  stop_workers();
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // パタンを格納するオブジェクト
+  PatMgr& mPatMgr;
+
+  // ワーカースレッドのリスト
+  // 呼び出したスレッドが 0 番めを受け持つので thread_num() - 1 個ある．
+  vector<std::thread> mWorkerList;
+
+  // 以下のメンバを保護するミューテックス
+  std::mutex mMutex;
+
+  // ジョブの開始を知らせる条件変数
+  std::condition_variable mStartCond;
+
+  // ジョブの終了を知らせる条件変数
+  std::condition_variable mDoneCond;
+
+  // 実行中のジョブ
+  const std::function<void(int)>* mJob;
+
+  // 実行中のジョブ数
+  int mJobNum;
+
+  // ジョブを投入するたびに更新される番号
+  int mGeneration;
+
+  // 終了していないワーカースレッド数
+  int mRemain;
+
+  // ワーカースレッドを終了させる時 true にする．
+  bool mQuit;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief スレッド数を返す．
+inline
+int
+SimEngine::thread_num() const
+{
+  return mWorkerList.size() + 1;
+}
+
+// @brief 乱数パタンの1ワードを返す．
+// @param[in] seed 乱数の種
+// @param[in] id ノード番号
+// @param[in] pos ワード位置
+inline
+ymuint64
+SimEngine::random_word(ymuint64 seed,
+		       int id,
+		       int pos)
+{
+  // splitmix64 の出力関数をカウンタに適用する．
+  ymuint64 x = seed;
+  x += ((static_cast<ymuint64>(id) << 32) | static_cast<ymuint32>(pos)) * 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+END_NAMESPACE_FRAIG
+
+#endif // SIMENGINE_H
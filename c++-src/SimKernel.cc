@@ -0,0 +1,311 @@
+﻿
+/// @file SimKernel.cc
+/// @brief SimKernel の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "SimKernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMKERNEL_X86 1
+#include <immintrin.h>
+#else
+#define SIMKERNEL_X86 0
+#endif
+
+
+BEGIN_NAMESPACE_FRAIG
+
+BEGIN_NONAMESPACE
+
+// 反転フラグをマスクに変換する．
+inline
+ymuint64
+inv_mask(bool inv)
+{
+  return inv ? ~0ULL : 0ULL;
+}
+
+//////////////////////////////////////////////////////////////////////
+// 汎用版
+//////////////////////////////////////////////////////////////////////
+
+void
+and_pat_generic(ymuint64* dst,
+		const ymuint64* src1,
+		const ymuint64* src2,
+		int n,
+		bool inv1,
+		bool inv2)
+{
+  ymuint64 mask1 = inv_mask(inv1);
+  ymuint64 mask2 = inv_mask(inv2);
+  for ( int i = 0; i < n; ++ i ) {
+    dst[i] = (src1[i] ^ mask1) & (src2[i] ^ mask2);
+  }
+}
+
+bool
+equal_pat_generic(const ymuint64* src1,
+		  const ymuint64* src2,
+		  int n,
+		  bool inv)
+{
+  ymuint64 mask = inv_mask(inv);
+  for ( int i = 0; i < n; ++ i ) {
+    if ( src1[i] != (src2[i] ^ mask) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#if SIMKERNEL_X86
+
+//////////////////////////////////////////////////////////////////////
+// AVX2 版
+//////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2")))
+void
+and_pat_avx2(ymuint64* dst,
+	     const ymuint64* src1,
+	     const ymuint64* src2,
+	     int n,
+	     bool inv1,
+	     bool inv2)
+{
+  __m256i mask1 = _mm256_set1_epi64x(inv_mask(inv1));
+  __m256i mask2 = _mm256_set1_epi64x(inv_mask(inv2));
+  int i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + i));
+    __m256i r = _mm256_and_si256(_mm256_xor_si256(a, mask1),
+				 _mm256_xor_si256(b, mask2));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), r);
+  }
+  and_pat_generic(dst + i, src1 + i, src2 + i, n - i, inv1, inv2);
+}
+
+__attribute__((target("avx2")))
+bool
+equal_pat_avx2(const ymuint64* src1,
+	       const ymuint64* src2,
+	       int n,
+	       bool inv)
+{
+  __m256i mask = _mm256_set1_epi64x(inv_mask(inv));
+  int i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + i));
+    __m256i d = _mm256_xor_si256(_mm256_xor_si256(a, b), mask);
+    if ( !_mm256_testz_si256(d, d) ) {
+      return false;
+    }
+  }
+  return equal_pat_generic(src1 + i, src2 + i, n - i, inv);
+}
+
+//////////////////////////////////////////////////////////////////////
+// AVX-512 版
+//////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx512f")))
+void
+and_pat_avx512(ymuint64* dst,
+	       const ymuint64* src1,
+	       const ymuint64* src2,
+	       int n,
+	       bool inv1,
+	       bool inv2)
+{
+  __m512i mask1 = _mm512_set1_epi64(inv_mask(inv1));
+  __m512i mask2 = _mm512_set1_epi64(inv_mask(inv2));
+  int i = 0;
+  for ( ; i + 8 <= n; i += 8 ) {
+    __m512i a = _mm512_loadu_si512(src1 + i);
+    __m512i b = _mm512_loadu_si512(src2 + i);
+    __m512i r = _mm512_and_si512(_mm512_xor_si512(a, mask1),
+				 _mm512_xor_si512(b, mask2));
+    _mm512_storeu_si512(dst + i, r);
+  }
+  and_pat_generic(dst + i, src1 + i, src2 + i, n - i, inv1, inv2);
+}
+
+__attribute__((target("avx512f")))
+bool
+equal_pat_avx512(const ymuint64* src1,
+		 const ymuint64* src2,
+		 int n,
+		 bool inv)
+{
+  __m512i mask = _mm512_set1_epi64(inv_mask(inv));
+  int i = 0;
+  for ( ; i + 8 <= n; i += 8 ) {
+    __m512i a = _mm512_loadu_si512(src1 + i);
+    __m512i b = _mm512_loadu_si512(src2 + i);
+    __m512i d = _mm512_xor_si512(_mm512_xor_si512(a, b), mask);
+    if ( _mm512_test_epi64_mask(d, d) != 0 ) {
+      return false;
+    }
+  }
+  return equal_pat_generic(src1 + i, src2 + i, n - i, inv);
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// 関数の切り替え
+//////////////////////////////////////////////////////////////////////
+
+typedef void (*AndFunc)(ymuint64*, const ymuint64*, const ymuint64*,
+			int, bool, bool);
+
+typedef bool (*EqualFunc)(const ymuint64*, const ymuint64*, int, bool);
+
+// 現在の実装
+struct KernelTable
+{
+  SimKernel::Type mType;
+  AndFunc mAndFunc;
+  EqualFunc mEqualFunc;
+};
+
+// 実装の種類に対応する関数を設定する．
+void
+set_table(KernelTable& table,
+	  SimKernel::Type type)
+{
+  table.mType = type;
+  switch ( type ) {
+#if SIMKERNEL_X86
+  case SimKernel::kAvx512:
+    table.mAndFunc = and_pat_avx512;
+    table.mEqualFunc = equal_pat_avx512;
+    break;
+
+  case SimKernel::kAvx2:
+    table.mAndFunc = and_pat_avx2;
+    table.mEqualFunc = equal_pat_avx2;
+    break;
+#endif
+
+  default:
+    table.mType = SimKernel::kGeneric;
+    table.mAndFunc = and_pat_generic;
+    table.mEqualFunc = equal_pat_generic;
+    break;
+  }
+}
+
+// 使える中で一番速い実装を選ぶ．
+KernelTable
+init_table()
+{
+  KernelTable table;
+  if ( SimKernel::is_supported(SimKernel::kAvx512) ) {
+    set_table(table, SimKernel::kAvx512);
+  }
+  else if ( SimKernel::is_supported(SimKernel::kAvx2) ) {
+    set_table(table, SimKernel::kAvx2);
+  }
+  else {
+    set_table(table, SimKernel::kGeneric);
+  }
+  return table;
+}
+
+KernelTable&
+kernel_table()
+{
+  static KernelTable the_table = init_table();
+  return the_table;
+}
+
+END_NONAMESPACE
+
+
+//////////////////////////////////////////////////////////////////////
+// SimKernel
+//////////////////////////////////////////////////////////////////////
+
+// @brief AND 演算を行う．
+void
+SimKernel::and_pat(ymuint64* dst,
+		   const ymuint64* src1,
+		   const ymuint64* src2,
+		   int n,
+		   bool inv1,
+		   bool inv2)
+{
+  (*kernel_table().mAndFunc)(dst, src1, src2, n, inv1, inv2);
+}
+
+// @brief 2つのパタンが等しいか調べる．
+bool
+SimKernel::equal_pat(const ymuint64* src1,
+		     const ymuint64* src2,
+		     int n,
+		     bool inv)
+{
+  return (*kernel_table().mEqualFunc)(src1, src2, n, inv);
+}
+
+// @brief 現在の実装の種類を返す．
+SimKernel::Type
+SimKernel::type()
+{
+  return kernel_table().mType;
+}
+
+// @brief 実装の種類を返す．
+bool
+SimKernel::set_type(Type type)
+{
+  if ( !is_supported(type) ) {
+    return false;
+  }
+  set_table(kernel_table(), type);
+  return true;
+}
+
+// @brief 実装の種類が使えるか調べる．
+bool
+SimKernel::is_supported(Type type)
+{
+  switch ( type ) {
+  case kGeneric:
+    return true;
+
+#if SIMKERNEL_X86
+  case kAvx2:
+    return __builtin_cpu_supports("avx2");
+
+  case kAvx512:
+    return __builtin_cpu_supports("avx512f");
+#endif
+
+  default:
+    break;
+  }
+  return false;
+}
+
+// @brief 実装の種類の名前を返す．
+const char*
+SimKernel::type_name(Type type)
+{
+  switch ( type ) {
+  case kGeneric: return "generic";
+  case kAvx2:    return "avx2";
+  case kAvx512:  return "avx512";
+  }
+  return "unknown";
+}
+
+END_NAMESPACE_FRAIG
@@ -0,0 +1,103 @@
+﻿#ifndef SIMKERNEL_H
+#define SIMKERNEL_H
+
+/// @file SimKernel.h
+/// @brief SimKernel のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "ym/fraig.h"
+
+
+BEGIN_NAMESPACE_FRAIG
+
+//////////////////////////////////////////////////////////////////////
+/// @class SimKernel SimKernel.h "SimKernel.h"
+/// @brief シミュレーションパタンのビット並列演算を行う関数群
+///
+/// 実際の処理は実行時に CPU の機能を調べて
+/// AVX-512, AVX2, 汎用版のいずれかが選ばれる．
+//////////////////////////////////////////////////////////////////////
+class SimKernel
+{
+public:
+
+  /// @brief 実装の種類
+  enum Type {
+    /// @brief 汎用版
+    kGeneric,
+    /// @brief AVX2 版
+    kAvx2,
+    /// @brief AVX-512 版
+    kAvx512
+  };
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 演算関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief AND 演算を行う．
+  /// @param[in] dst 結果を格納する領域
+  /// @param[in] src1, src2 オペランド
+  /// @param[in] n ワード数
+  /// @param[in] inv1, inv2 オペランドの反転フラグ
+  static
+  void
+  and_pat(ymuint64* dst,
+	  const ymuint64* src1,
+	  const ymuint64* src2,
+	  int n,
+	  bool inv1,
+	  bool inv2);
+
+  /// @brief 2つのパタンが等しいか調べる．
+  /// @param[in] src1, src2 オペランド
+  /// @param[in] n ワード数
+  /// @param[in] inv true の時は src2 を反転させて比較する．
+  static
+  bool
+  equal_pat(const ymuint64* src1,
+	    const ymuint64* src2,
+	    int n,
+	    bool inv);
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 実装の選択に関する関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 現在の実装の種類を返す．
+  static
+  Type
+  type();
+
+  /// @brief 実装の種類を返す．
+  /// @param[in] type 実装の種類
+  /// @retval true 設定が成功した．
+  /// @retval false この CPU では使えない種類だった．
+  static
+  bool
+  set_type(Type type);
+
+  /// @brief 実装の種類が使えるか調べる．
+  /// @param[in] type 実装の種類
+  static
+  bool
+  is_supported(Type type);
+
+  /// @brief 実装の種類の名前を返す．
+  static
+  const char*
+  type_name(Type type);
+
+};
+
+END_NAMESPACE_FRAIG
+
+#endif // SIMKERNEL_H
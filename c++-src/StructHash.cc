@@ -8,8 +8,6 @@
 
 
 #include "StructHash.h"
-#include "FraigNode.h"
-#include "ym/Range.h"
 
 
 BEGIN_NAMESPACE_FRAIG
@@ -19,8 +17,10 @@ BEGIN_NAMESPACE_FRAIG
 //////////////////////////////////////////////////////////////////////
 
 // @brief コンストラクタ
-StructHash::StructHash()
+StructHash::StructHash() :
+  mNum(0)
 {
+  alloc_table(1024);
 }
 
 // @brief デストラクタ
@@ -29,56 +29,69 @@ StructHash::~StructHash()
 }
 
 // @brief 同じ構造を持つノードを探す．
-// @param[in] handle1, handle2 ファンインのハンドル
-// @param[out] ans 答のハンドル
-// @retval true ノードが見つかった．
-// @retval false ノードが見つからなかった．
-bool
-StructHash::find(FraigHandle handle1,
-		 FraigHandle handle2,
-		 FraigHandle& ans)
+// @param[in] lit0, lit1 ファンインのリテラル番号
+// @return ノード番号を返す．
+int
+StructHash::find(ymuint32 lit0,
+		 ymuint32 lit1) const
 {
-  SizeType pos = hash_func(handle1, handle2) % mHashSize;
-  for ( auto node1 = mTable[pos]; node1; node1 = node1->mLink1 ) {
-    if ( node1->fanin0_handle() == handle1 &&
-	 node1->fanin1_handle() == handle2 ) {
-      // 同じノードがあった．
-      ans = node1->rep_handle();
-      return true;
-    }
-  }
-  return false;
+  // 見つからなかった場合は空きスロットの mId(= -1) になる．
+  return mTable[find_slot(lit0, lit1)].mId;
 }
 
 // @brief ノードを追加する．
-// @param[in] node 追加するノード
+// @param[in] lit0, lit1 ファンインのリテラル番号
+// @param[in] id ノード番号
 void
-StructHash::add(FraigNode* node)
+StructHash::add(ymuint32 lit0,
+		ymuint32 lit1,
+		int id)
 {
+  ASSERT_COND( id >= 0 );
+
   if ( mNum >= mNextLimit ) {
     // テーブルを拡大して再ハッシュする．
-    auto old_table = mTable;
-    auto old_size = mHashSize;
-    alloc_table(old_size * 2);
-    for ( int pos: Range(old_size) ) {
-      for ( auto node1 = old_table[pos]; node1; ) {
-	auto tmp = node1;
-	node1 = tmp->mLink1;
-	SizeType pos1 = hash_func(tmp->fanin0_handle(), tmp->fanin1_handle()) % mHashSize;
-	tmp->mLink1 = mTable[pos1];
-	mTable[pos1] = tmp;
-      }
-    }
-    delete [] old_table;
+    alloc_table(mTable.size() * 2);
   }
 
   // 構造ハッシュ表に登録する．
-  FraigHandle handle1 = node->fanin0_handle();
-  FraigHandle handle2 = node->fanin1_handle();
-  SizeType pos = hash_func(handle1, handle2) % mHashSize;
-  node->mLink1 = mTable[pos];
-  mTable[pos] = node;
+  Slot& slot = mTable[find_slot(lit0, lit1)];
+  ASSERT_COND( slot.mId == -1 );
+  slot.mLit0 = lit0;
+  slot.mLit1 = lit1;
+  slot.mId = id;
   ++ mNum;
 }
 
+// @brief 内容を空にする．
+void
+StructHash::clear()
+{
+  for ( auto& slot: mTable ) {
+    slot.mId = -1;
+  }
+  mNum = 0;
+}
+
+// @brief ハッシュ表を確保する．
+// @param[in] req_size サイズ
+void
+StructHash::alloc_table(int req_size)
+{
+  int size = 1024;
+  while ( size < req_size ) {
+    size <<= 1;
+  }
+
+  vector<Slot> old_table(size, Slot{0, 0, -1});
+  mTable.swap(old_table);
+  mNextLimit = size / 2;
+
+  for ( auto& slot: old_table ) {
+    if ( slot.mId != -1 ) {
+      mTable[find_slot(slot.mLit0, slot.mLit1)] = slot;
+    }
+  }
+}
+
 END_NAMESPACE_FRAIG
@@ -9,20 +9,24 @@
 /// All rights reserved.
 
 
-#include "FraigHash.h"
-#include "ym/FraigHandle.h"
+#include "ym/fraig.h"
 
 
 BEGIN_NAMESPACE_FRAIG
 
-class FraigNode;
-
 //////////////////////////////////////////////////////////////////////
 /// @class StructHash StructHash.h "StructHash.h"
 /// @brief FraigNode の構造ハッシュ表を実装するためのクラス
+///
+/// ファンインのリテラル番号(ノード番号 * 2 + 極性)の対をキーにして
+/// ノード番号を登録する．
+///
+/// 線形探査のオープンアドレス法を用いる．
+/// キーとノード番号はスロットに直接持つので，
+/// 探索はたいてい1つか2つのキャッシュラインで済む．
+/// 要素の削除はできない(clear() のみ)．
 //////////////////////////////////////////////////////////////////////
-class StructHash :
-  public FraigHash
+class StructHash
 {
 public:
 
@@ -39,19 +43,21 @@ public:
   //////////////////////////////////////////////////////////////////////
 
   /// @brief 同じ構造を持つノードを探す．
-  /// @param[in] handle1, handle2 ファンインのハンドル
-  /// @param[out] ans 答のハンドル
-  /// @retval true ノードが見つかった．
-  /// @retval false ノードが見つからなかった．
-  bool
-  find(FraigHandle handle1,
-       FraigHandle handle2,
-       FraigHandle& ans);
+  /// @param[in] lit0, lit1 ファンインのリテラル番号
+  /// @return ノード番号を返す．
+  ///
+  /// 見つからなかった場合は -1 を返す．
+  int
+  find(ymuint32 lit0,
+       ymuint32 lit1) const;
 
   /// @brief ノードを追加する．
-  /// @param[in] node 追加するノード
+  /// @param[in] lit0, lit1 ファンインのリテラル番号
+  /// @param[in] id ノード番号
   void
-  add(FraigNode* node);
+  add(ymuint32 lit0,
+      ymuint32 lit1,
+      int id);
 
   /// @brief 内容を空にする．
   ///
@@ -59,17 +65,56 @@ public:
   void
   clear();
 
+  /// @brief 登録されている要素数を返す．
+  int
+  num() const;
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられるデータ構造
+  //////////////////////////////////////////////////////////////////////
+
+  // ハッシュ表のスロット
+  struct Slot
+  {
+    // ファンイン0 のリテラル番号
+    ymuint32 mLit0;
+
+    // ファンイン1 のリテラル番号
+    ymuint32 mLit1;
+
+    // ノード番号
+    // 空きスロットの場合は -1
+    int mId;
+  };
+
 
 private:
   //////////////////////////////////////////////////////////////////////
   // 内部で用いられる関数
   //////////////////////////////////////////////////////////////////////
 
-  /// @brief FraigNode のハッシュ関数
+  /// @brief ハッシュ表を確保する．
+  /// @param[in] req_size サイズ
+  ///
+  /// 登録済みの要素は新しい表に移される．
+  void
+  alloc_table(int req_size);
+
+  /// @brief キーに対応するスロットの位置を返す．
+  /// @param[in] lit0, lit1 ファンインのリテラル番号
+  ///
+  /// キーが登録されていない場合は挿入すべき空きスロットの位置を返す．
+  SizeType
+  find_slot(ymuint32 lit0,
+	    ymuint32 lit1) const;
+
+  /// @brief ハッシュ関数
   static
   SizeType
-  hash_func(FraigHandle handle1,
-	    FraigHandle handle2);
+  hash_func(ymuint32 lit0,
+	    ymuint32 lit1);
 
 
 private:
@@ -77,6 +122,17 @@ private:
   // データメンバ
   //////////////////////////////////////////////////////////////////////
 
+  // ハッシュ表
+  // サイズは常に2のべき乗
+  vector<Slot> mTable;
+
+  // 登録されている要素数
+  int mNum;
+
+  // ハッシュ表を拡大する目安
+  // 探査列が長くならないように使用率を 1/2 以下に保つ．
+  int mNextLimit;
+
 };
 
 
@@ -84,13 +140,47 @@ private:
 // インライン関数の定義
 //////////////////////////////////////////////////////////////////////
 
-// FraigNode のハッシュ関数
+// @brief 登録されている要素数を返す．
+inline
+int
+StructHash::num() const
+{
+  return mNum;
+}
+
+// ハッシュ関数
+inline
+SizeType
+StructHash::hash_func(ymuint32 lit0,
+		      ymuint32 lit1)
+{
+  // 下位ビットでマスクするので MurmurHash3 の fmix64 で
+  // 全ビットをよく混ぜておく．
+  ymuint64 x = (static_cast<ymuint64>(lit0) << 32) | lit1;
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return static_cast<SizeType>(x);
+}
+
+// @brief キーに対応するスロットの位置を返す．
 inline
 SizeType
-StructHash::hash_func(FraigHandle handle1,
-		      FraigHandle handle2)
+StructHash::find_slot(ymuint32 lit0,
+		      ymuint32 lit1) const
 {
-  return handle1.mPackedData + handle2.mPackedData;
+  SizeType mask = mTable.size() - 1;
+  SizeType pos = hash_func(lit0, lit1) & mask;
+  for ( ; ; ) {
+    const Slot& slot = mTable[pos];
+    if ( slot.mId == -1 ||
+	 (slot.mLit0 == lit0 && slot.mLit1 == lit1) ) {
+      return pos;
+    }
+    pos = (pos + 1) & mask;
+  }
 }
 
 END_NAMESPACE_FRAIG
@@ -0,0 +1,253 @@
+﻿
+/// @file SweepWorker.cc
+/// @brief SweepWorker の実装ファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "SweepWorker.h"
+#include "FraigMgrImpl.h"
+#include "FraigNode.h"
+#include "ym/SatModel.h"
+
+
+BEGIN_NAMESPACE_FRAIG
+
+//////////////////////////////////////////////////////////////////////
+// クラス SweepWorker
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+// @param[in] mgr ノードを持つオブジェクト
+// @param[in] solver_type SAT ソルバの種類
+// @param[in] conflict_limit コンフリクト数の上限
+// @param[in] propagation_limit 含意操作の回数の上限
+// @param[in] time_limit 時間の上限(秒)
+SweepWorker::SweepWorker(const FraigMgrImpl& mgr,
+			 const SatSolverType& solver_type,
+			 SizeType conflict_limit,
+			 SizeType propagation_limit,
+			 int time_limit) :
+  mMgr(mgr),
+  mSolverType(solver_type),
+  mSolver(new SatSolver(solver_type)),
+  mVarMap(mgr.node_num()),
+  mConflictLimit(conflict_limit),
+  mPropagationLimit(propagation_limit),
+  mTimeLimit(time_limit),
+  mStop(false),
+  mSolving(false),
+  mInterrupted(false)
+{
+}
+
+// @brief デストラクタ
+SweepWorker::~SweepWorker()
+{
+}
+
+// @brief 検査を行う．
+// @param[inout] query 対象の検査
+void
+SweepWorker::check(SweepQuery& query)
+{
+  // サポートが小さければ SAT を用いずに調べる．
+  query.mResult = mMgr.check_truth_table(query.mNode1, query.mNode2,
+					 query.mInv, query.mCex);
+  query.mTruthTable = (query.mResult != SatBool3::X);
+  if ( query.mTruthTable ) {
+    return;
+  }
+
+  SatLiteral lit2(load_cnf(query.mNode2), query.mInv);
+  if ( query.mNode1 == nullptr ) {
+    // lit2 = 1 が成り立たなければ定数と等価
+    SatBool3 stat = solve(vector<SatLiteral>{lit2});
+    if ( stat == SatBool3::False ) {
+      mSolver->add_clause(~lit2);
+      query.mResult = SatBool3::True;
+    }
+    else if ( stat == SatBool3::True ) {
+      get_cex(query.mCex);
+      query.mResult = SatBool3::False;
+    }
+    else {
+      query.mResult = SatBool3::X;
+    }
+    return;
+  }
+
+  SatLiteral lit1(load_cnf(query.mNode1));
+  SatBool3 stat = solve(vector<SatLiteral>{~lit1, lit2});
+  if ( stat == SatBool3::False ) {
+    stat = solve(vector<SatLiteral>{lit1, ~lit2});
+  }
+  if ( stat == SatBool3::False ) {
+    // 後の検査のために等価性を節として加えておく．
+    mSolver->add_clause(~lit1,  lit2);
+    mSolver->add_clause( lit1, ~lit2);
+    query.mResult = SatBool3::True;
+  }
+  else if ( stat == SatBool3::True ) {
+    get_cex(query.mCex);
+    query.mResult = SatBool3::False;
+  }
+  else {
+    query.mResult = SatBool3::X;
+  }
+}
+
+// @brief 他のスレッドで証明された等価性を節として加える．
+// @param[in] query 結果が SatBool3::True の検査
+void
+SweepWorker::add_equiv(const SweepQuery& query)
+{
+  ASSERT_COND( query.mResult == SatBool3::True );
+
+  SatVarId var2 = mVarMap[query.mNode2->id()];
+  if ( var2 == SatVarId() ) {
+    return;
+  }
+  SatLiteral lit2(var2, query.mInv);
+  if ( query.mNode1 == nullptr ) {
+    mSolver->add_clause(~lit2);
+    return;
+  }
+  SatVarId var1 = mVarMap[query.mNode1->id()];
+  if ( var1 == SatVarId() ) {
+    return;
+  }
+  SatLiteral lit1(var1);
+  mSolver->add_clause(~lit1,  lit2);
+  mSolver->add_clause( lit1, ~lit2);
+}
+
+// @brief 検査を中止させる．
+void
+SweepWorker::stop()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStop = true;
+  if ( mSolving ) {
+    mSolver->stop();
+    mInterrupted = true;
+  }
+}
+
+// @brief stop() で立てたフラグを下ろす．
+void
+SweepWorker::clear_stop()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStop = false;
+  if ( mInterrupted ) {
+    // ソルバによっては中止の状態が次の SAT まで残るので作り直す．
+    mSolver.reset(new SatSolver(mSolverType));
+    mVarMap.clear();
+    mVarMap.resize(mMgr.node_num());
+    mInputList.clear();
+    mInterrupted = false;
+  }
+}
+
+// @brief ノードのファンインコーンの CNF 式を読み込む．
+// @param[in] node 対象のノード
+// @return node の変数番号を返す．
+SatVarId
+SweepWorker::load_cnf(FraigNode* node)
+{
+  // ポートフォリオではソルバを使い回すのでノードが増えていることがある．
+  // ノード番号は garbage_collect() まで変わらない．
+  if ( mVarMap.size() < static_cast<SizeType>(mMgr.node_num()) ) {
+    mVarMap.resize(mMgr.node_num());
+  }
+
+  if ( mVarMap[node->id()] != SatVarId() ) {
+    return mVarMap[node->id()];
+  }
+
+  // このソルバは sweep() の間か次の garbage_collect() までしか使わないので
+  // 変数の除去は考えずにすべて凍結する．
+  vector<FraigNode*> node_list;
+  vector<FraigNode*> node_stack{node};
+  while ( !node_stack.empty() ) {
+    FraigNode* node1 = node_stack.back();
+    node_stack.pop_back();
+    if ( mVarMap[node1->id()] != SatVarId() ) {
+      continue;
+    }
+    SatVarId var = mSolver->new_variable();
+    mSolver->freeze_literal(SatLiteral(var));
+    mVarMap[node1->id()] = var;
+    node_list.push_back(node1);
+    if ( node1->is_input() ) {
+      mInputList.push_back(node1);
+    }
+    else {
+      for ( int pos: { 0, 1 } ) {
+	FraigNode* inode = mMgr.node(node1->fanin_id(pos));
+	if ( mVarMap[inode->id()] == SatVarId() ) {
+	  node_stack.push_back(inode);
+	}
+      }
+    }
+  }
+
+  for ( auto node1: node_list ) {
+    if ( node1->is_and() ) {
+      SatLiteral lito(mVarMap[node1->id()]);
+      SatLiteral lit1(mVarMap[node1->fanin0_id()], node1->fanin0_inv());
+      SatLiteral lit2(mVarMap[node1->fanin1_id()], node1->fanin1_inv());
+      mSolver->add_clause(~lit1, ~lit2, lito);
+      mSolver->add_clause( lit1, ~lito);
+      mSolver->add_clause( lit2, ~lito);
+    }
+  }
+
+  return mVarMap[node->id()];
+}
+
+// @brief 予算をセットして SAT 問題を解く．
+// @param[in] assumptions 仮定
+SatBool3
+SweepWorker::solve(const vector<SatLiteral>& assumptions)
+{
+  mSolver->set_conflict_budget(mConflictLimit);
+  mSolver->set_propagation_budget(mPropagationLimit);
+
+  // mSolving が true の間だけ stop() がソルバを止める．
+  // 判定から solve() の開始までの間の stop() は取りこぼされることがある．
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if ( mStop ) {
+      return SatBool3::X;
+    }
+    mSolving = true;
+  }
+  SatBool3 stat = mSolver->solve(assumptions, mTimeLimit);
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSolving = false;
+  }
+  return stat;
+}
+
+// @brief 直前の SAT の反例を取り出す．
+// @param[out] cex 反例の入力値
+void
+SweepWorker::get_cex(vector<bool>& cex)
+{
+  // 読み込まれていない入力は問題に関係しないので 0 とする．
+  const SatModel& model = mSolver->model();
+  cex.clear();
+  cex.resize(mMgr.input_num(), false);
+  for ( auto node: mInputList ) {
+    if ( model[mVarMap[node->id()]] == SatBool3::True ) {
+      cex[node->input_id()] = true;
+    }
+  }
+}
+
+END_NAMESPACE_FRAIG
@@ -0,0 +1,224 @@
+﻿#ifndef SWEEPWORKER_H
+#define SWEEPWORKER_H
+
+/// @file SweepWorker.h
+/// @brief SweepWorker のヘッダファイル
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "ym/fraig.h"
+#include "ym/SatSolver.h"
+#include "ym/SatBool3.h"
+#include <mutex>
+
+
+BEGIN_NAMESPACE_FRAIG
+
+class FraigMgrImpl;
+class FraigNode;
+
+//////////////////////////////////////////////////////////////////////
+/// @class SweepQuery SweepWorker.h "SweepWorker.h"
+/// @brief sweep() で行う1つの検査を表す構造体
+//////////////////////////////////////////////////////////////////////
+struct SweepQuery
+{
+  /// @brief コンストラクタ
+  /// @param[in] node1 比較するノード
+  /// @param[in] node2 対象のノード
+  /// @param[in] inv 極性
+  ///
+  /// 結果は未定(SatBool3::X)に初期化される．
+  SweepQuery(FraigNode* node1 = nullptr,
+	     FraigNode* node2 = nullptr,
+	     bool inv = false);
+
+  // 比較するノード
+  // nullptr の時は定数との比較を表す．
+  FraigNode* mNode1;
+
+  // 対象のノード
+  FraigNode* mNode2;
+
+  // mNode1 がある時は false で同相，true で逆相を表す．
+  // mNode1 が nullptr の時は false で定数0，true で定数1を表す．
+  bool mInv;
+
+  // 結果
+  SatBool3 mResult;
+
+  // 反例の入力値(入力番号がインデックス)
+  // mResult が SatBool3::False の時のみ意味を持つ．
+  vector<bool> mCex;
+
+  // 検査に要した時間
+  double mTime;
+
+  // SAT を用いずに真理値表で調べた時 true
+  bool mTruthTable;
+};
+
+
+//////////////////////////////////////////////////////////////////////
+/// @class SweepWorker SweepWorker.h "SweepWorker.h"
+/// @brief sweep() やポートフォリオで1つのスレッドが用いる SAT ソルバ
+///
+/// 各スレッドは自分の SAT ソルバとノードごとの変数番号の表を持ち，
+/// 必要なファンインコーンの CNF だけを読み込む．
+/// ノードの構造は読み出すだけなので複数のスレッドから同時に使える．
+//////////////////////////////////////////////////////////////////////
+class SweepWorker
+{
+public:
+
+  /// @brief コンストラクタ
+  /// @param[in] mgr ノードを持つオブジェクト
+  /// @param[in] solver_type SAT ソルバの種類
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// 上限は1回の SAT ごとに適用される．0 は制限なしを表す．
+  SweepWorker(const FraigMgrImpl& mgr,
+	      const SatSolverType& solver_type,
+	      SizeType conflict_limit,
+	      SizeType propagation_limit,
+	      int time_limit);
+
+  /// @brief デストラクタ
+  ~SweepWorker();
+
+
+public:
+  //////////////////////////////////////////////////////////////////////
+  // 外部インターフェイス
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief 検査を行う．
+  /// @param[inout] query 対象の検査
+  ///
+  /// 結果は query.mResult と query.mCex に書き込まれる．
+  void
+  check(SweepQuery& query);
+
+  /// @brief 他のスレッドで証明された等価性を節として加える．
+  /// @param[in] query 結果が SatBool3::True の検査
+  ///
+  /// 対象のノードの CNF が読み込まれていない場合は何もしない．
+  void
+  add_equiv(const SweepQuery& query);
+
+  /// @brief 検査を中止させる．
+  ///
+  /// 他のスレッドから呼ばれることを仮定している．
+  /// 実行中の SAT はアボートし，以降の SAT は clear_stop() を呼ぶまで
+  /// 解かずにアボートとなる．
+  /// ただし SAT を解き始める直前に呼ばれた場合はソルバによっては
+  /// 取りこぼされるので，呼び出し側は check() が終わるまで繰り返し呼ぶ．
+  void
+  stop();
+
+  /// @brief stop() で立てたフラグを下ろす．
+  ///
+  /// 次の検査を始める前に check() を呼ぶスレッドの外から呼ぶ．
+  /// SAT を解いている最中に止めたソルバは中止の状態が残っている
+  /// かもしれないので作り直す．CNF は必要になった時に読み込み直す．
+  void
+  clear_stop();
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // 内部で用いられる関数
+  //////////////////////////////////////////////////////////////////////
+
+  /// @brief ノードのファンインコーンの CNF 式を読み込む．
+  /// @param[in] node 対象のノード
+  /// @return node の変数番号を返す．
+  SatVarId
+  load_cnf(FraigNode* node);
+
+  /// @brief 予算をセットして SAT 問題を解く．
+  /// @param[in] assumptions 仮定
+  SatBool3
+  solve(const vector<SatLiteral>& assumptions);
+
+  /// @brief 直前の SAT の反例を取り出す．
+  /// @param[out] cex 反例の入力値
+  void
+  get_cex(vector<bool>& cex);
+
+
+private:
+  //////////////////////////////////////////////////////////////////////
+  // データメンバ
+  //////////////////////////////////////////////////////////////////////
+
+  // ノードを持つオブジェクト
+  const FraigMgrImpl& mMgr;
+
+  // SAT ソルバの種類
+  SatSolverType mSolverType;
+
+  // SAT ソルバ
+  unique_ptr<SatSolver> mSolver;
+
+  // ノード番号をキーにした変数番号の表
+  // 読み込まれていないノードは SatVarId() になる．
+  vector<SatVarId> mVarMap;
+
+  // 読み込まれた入力ノードのリスト
+  vector<FraigNode*> mInputList;
+
+  // コンフリクト数の上限
+  SizeType mConflictLimit;
+
+  // 含意操作の回数の上限
+  SizeType mPropagationLimit;
+
+  // 時間の上限(秒)
+  int mTimeLimit;
+
+  // mStop, mSolving, mInterrupted を守る mutex
+  // stop() が CNF を読み込んでいる最中のソルバに触らないようにする．
+  std::mutex mMutex;
+
+  // stop() が呼ばれたら true になるフラグ
+  bool mStop;
+
+  // mSolver が SAT を解いている間 true になるフラグ
+  bool mSolving;
+
+  // SAT を解いている最中の mSolver を止めたら true になるフラグ
+  bool mInterrupted;
+
+};
+
+
+//////////////////////////////////////////////////////////////////////
+// インライン関数の定義
+//////////////////////////////////////////////////////////////////////
+
+// @brief コンストラクタ
+// @param[in] node1 比較するノード
+// @param[in] node2 対象のノード
+// @param[in] inv 極性
+inline
+SweepQuery::SweepQuery(FraigNode* node1,
+		       FraigNode* node2,
+		       bool inv) :
+  mNode1(node1),
+  mNode2(node2),
+  mInv(inv),
+  mResult(SatBool3::X),
+  mTime(0.0),
+  mTruthTable(false)
+{
+}
+
+END_NAMESPACE_FRAIG
+
+#endif // SWEEPWORKER_H
@@ -10,22 +10,21 @@
 
 
 #include "ym/fraig.h"
-#include "ym/SatLiteral.h"
 
 
 BEGIN_NAMESPACE_FRAIG
 
-class FraigNode;
-
 //////////////////////////////////////////////////////////////////////
 /// @class FraigHandle FraigHandle.h "ym/FraigHandle.h"
 /// @brief Fraig の枝を表すクラス
+///
+/// AIGER と同じくノード番号 x 2 + 反転属性の32ビットのリテラルで表す．
+/// ノード番号 0 は定数ノードに予約されているので，
+/// リテラル 0 が定数0，リテラル 1 が定数1となる．
+/// ポインタを含まないので実行ごとに値が変わることはない．
 //////////////////////////////////////////////////////////////////////
 class FraigHandle
 {
-  friend class FraigNode;
-  friend class StructHash;
-
 public:
   //////////////////////////////////////////////////////////////////////
   // コンストラクタ/デストラクタと生成/内容の設定
@@ -35,9 +34,9 @@ public:
   FraigHandle();
 
   /// @brief 内容を設定したコンストラクタ
-  /// @param[in] node ノード
+  /// @param[in] id ノード番号
   /// @param[in] inv 反転している時に true とするフラグ
-  FraigHandle(FraigNode* node,
+  FraigHandle(int id,
 	      bool inv);
 
   /// @brief 定数０のハンドルを返す．
@@ -50,6 +49,12 @@ public:
   FraigHandle
   one();
 
+  /// @brief リテラルからハンドルを作る．
+  /// @param[in] lit リテラル ( = ノード番号 x 2 + 反転属性 )
+  static
+  FraigHandle
+  from_lit(ymuint32 lit);
+
   /// @brief デストラクタ
   ~FraigHandle();
 
@@ -60,10 +65,10 @@ public:
   //////////////////////////////////////////////////////////////////////
 
   /// @brief 内容を設定する．
-  /// @param[in] node ノード
+  /// @param[in] id ノード番号
   /// @param[in] inv 反転している時に true とするフラグ
   void
-  set(FraigNode* node,
+  set(int id,
       bool inv);
 
 
@@ -76,13 +81,17 @@ public:
   FraigHandle
   operator~() const;
 
-  /// @brief ノードを得る．
-  FraigNode*
-  node() const;
+  /// @brief ノード番号を得る．
+  ///
+  /// 定数の場合は 0 を返す．
+  int
+  node_id() const;
 
-  /// @brief 対応するリテラルを得る．
-  SatLiteral
-  literal() const;
+  /// @brief リテラルを得る．
+  ///
+  /// = node_id() * 2 + inv()
+  ymuint32
+  lit() const;
 
   /// @brief 極性を得る．
   /// @return 反転しているとき true を返す．
@@ -103,43 +112,6 @@ public:
   bool
   is_const() const;
 
-  /// @brief 外部入力ノードへのハンドルのとき true を返す．
-  bool
-  is_input() const;
-
-  /// @brief 外部入力ノードへのハンドルのとき，入力番号を返す．
-  ///
-  /// is_input() == true の時のみ意味を持つ．
-  int
-  input_id() const;
-
-  /// @brief ANDノードへのハンドルのとき true を返す．
-  bool
-  is_and() const;
-
-  /// @brief pos で指示されたファンインのハンドルを得る．
-  /// @param[in] pos 位置 ( 0 or 1 )
-  ///
-  /// is_and() == true の時のみ意味を持つ．
-  FraigHandle
-  fanin_handle(int pos) const;
-
-  /// @brief fanin0 のハンドルを得る．
-  ///
-  /// is_and() == true の時のみ意味を持つ．
-  FraigHandle
-  fanin0_handle() const;
-
-  /// @brief fanin1 のハンドルを得る．
-  ///
-  /// is_and() == true の時のみ意味を持つ．
-  FraigHandle
-  fanin1_handle() const;
-
-  /// @brief 代表ハンドルを得る．
-  FraigHandle
-  rep_handle() const;
-
   /// @brief ハッシュ値を返す．
   SizeType
   hash_func() const;
@@ -163,7 +135,7 @@ private:
 
   /// @brief 内容を直接指定したコンストラクタ
   explicit
-  FraigHandle(ympuint data);
+  FraigHandle(ymuint32 lit);
 
 
 private:
@@ -171,8 +143,8 @@ private:
   // データメンバ
   //////////////////////////////////////////////////////////////////////
 
-  // すべてのデータをまとめたもの
-  ympuint mPackedData;
+  // ノード番号 x 2 + 反転属性
+  ymuint32 mLit;
 
 };
 
@@ -190,16 +162,6 @@ bool
 operator!=(FraigHandle src1,
 	   FraigHandle src2);
 
-/// @relates FraigHandle
-/// @brief 内容をダンプする関数
-/// @param[in] s 出力先のストリーム
-/// @param[in] src 根の枝
-/// @param[in] mark すでに処理したノードの番号を保持するマーク
-void
-dump_handle(ostream& s,
-	    FraigHandle src,
-	    unordered_set<int>& mark);
-
 /// @relates FraigHandle
 /// @brief 内容を出力する関数
 /// @param[in] s 出力先のストリーム
@@ -216,23 +178,23 @@ operator<<(ostream& s,
 // @brief 空のコンストラクタ
 inline
 FraigHandle::FraigHandle() :
-  mPackedData(0UL)
+  mLit(0U)
 {
 }
 
 // @brief 内容を直接指定したコンストラクタ
 inline
-FraigHandle::FraigHandle(ympuint data) :
-  mPackedData(data)
+FraigHandle::FraigHandle(ymuint32 lit) :
+  mLit(lit)
 {
 }
 
 // @brief 内容を設定したコンストラクタ
 inline
-FraigHandle::FraigHandle(FraigNode* node,
-			 bool inv)
+FraigHandle::FraigHandle(int id,
+			 bool inv) :
+  mLit(static_cast<ymuint32>(id) * 2 + static_cast<ymuint32>(inv))
 {
-  mPackedData = reinterpret_cast<ympuint>(node) | inv;
 }
 
 // @brief 定数０のハンドルを返す．
@@ -240,7 +202,7 @@ inline
 FraigHandle
 FraigHandle::zero()
 {
-  return FraigHandle(nullptr, false);
+  return FraigHandle(0U);
 }
 
 // @brief 定数1のハンドルを返す．
@@ -248,7 +210,15 @@ inline
 FraigHandle
 FraigHandle::one()
 {
-  return FraigHandle(nullptr, true);
+  return FraigHandle(1U);
+}
+
+// @brief リテラルからハンドルを作る．
+inline
+FraigHandle
+FraigHandle::from_lit(ymuint32 lit)
+{
+  return FraigHandle(lit);
 }
 
 // @brief デストラクタ
@@ -260,10 +230,10 @@ FraigHandle::~FraigHandle()
 // @brief 内容を設定する．
 inline
 void
-FraigHandle::set(FraigNode* node,
+FraigHandle::set(int id,
 		 bool inv)
 {
-  mPackedData = reinterpret_cast<ympuint>(node) | inv;
+  mLit = static_cast<ymuint32>(id) * 2 + static_cast<ymuint32>(inv);
 }
 
 // @brief 否定の枝を返す．
@@ -271,15 +241,23 @@ inline
 FraigHandle
 FraigHandle::operator~() const
 {
-  return FraigHandle(mPackedData ^ 1UL);
+  return FraigHandle(mLit ^ 1U);
+}
+
+// @brief ノード番号を得る．
+inline
+int
+FraigHandle::node_id() const
+{
+  return static_cast<int>(mLit >> 1);
 }
 
-// @brief ノードを得る．
+// @brief リテラルを得る．
 inline
-FraigNode*
-FraigHandle::node() const
+ymuint32
+FraigHandle::lit() const
 {
-  return reinterpret_cast<FraigNode*>(mPackedData & ~3UL);
+  return mLit;
 }
 
 // @brief 極性を得る．
@@ -288,7 +266,7 @@ inline
 bool
 FraigHandle::inv() const
 {
-  return static_cast<bool>(mPackedData & 1UL);
+  return static_cast<bool>(mLit & 1U);
 }
 
 // @brief 定数0を指しているとき true を返す．
@@ -296,7 +274,7 @@ inline
 bool
 FraigHandle::is_zero() const
 {
-  return mPackedData == 0UL;
+  return mLit == 0U;
 }
 
 // @brief 定数1を指しているとき true を返す．
@@ -304,7 +282,7 @@ inline
 bool
 FraigHandle::is_one() const
 {
-  return mPackedData == 1UL;
+  return mLit == 1U;
 }
 
 // @brief 定数を指しているとき true を返す．
@@ -312,7 +290,7 @@ inline
 bool
 FraigHandle::is_const() const
 {
-  return (mPackedData & ~1UL) == 0UL;
+  return (mLit & ~1U) == 0U;
 }
 
 // @brief ハッシュ値を返す．
@@ -320,7 +298,7 @@ inline
 SizeType
 FraigHandle::hash_func() const
 {
-  return static_cast<SizeType>(mPackedData);
+  return static_cast<SizeType>(mLit);
 }
 
 // @relates FraigHandle
@@ -330,7 +308,7 @@ bool
 operator==(FraigHandle src1,
 	   FraigHandle src2)
 {
-  return src1.mPackedData == src2.mPackedData;
+  return src1.mLit == src2.mLit;
 }
 
 // @relates FraigHandle
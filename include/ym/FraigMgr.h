@@ -66,6 +66,47 @@ public:
   node(int pos) const;
 #endif
 
+  /// @brief 外部入力数を得る．
+  int
+  input_num() const;
+
+  /// @brief 外部入力のハンドルを得る．
+  /// @param[in] pos 入力番号 ( 0 <= pos < input_num() )
+  FraigHandle
+  input_handle(int pos) const;
+
+  /// @brief 外部入力ノードへのハンドルのとき true を返す．
+  /// @param[in] handle 対象のハンドル
+  bool
+  is_input(FraigHandle handle) const;
+
+  /// @brief 外部入力ノードへのハンドルのとき，入力番号を返す．
+  /// @param[in] handle 対象のハンドル
+  ///
+  /// is_input(handle) == true の時のみ意味を持つ．
+  int
+  input_id(FraigHandle handle) const;
+
+  /// @brief ANDノードへのハンドルのとき true を返す．
+  /// @param[in] handle 対象のハンドル
+  bool
+  is_and(FraigHandle handle) const;
+
+  /// @brief ANDノードのファンインのハンドルを得る．
+  /// @param[in] handle 対象のハンドル
+  /// @param[in] pos 位置 ( 0 or 1 )
+  ///
+  /// is_and(handle) == true の時のみ意味を持つ．
+  /// handle の極性は結果に影響しない．
+  FraigHandle
+  fanin_handle(FraigHandle handle,
+	       int pos) const;
+
+  /// @brief 代表ハンドルを得る．
+  /// @param[in] handle 対象のハンドル
+  FraigHandle
+  rep_handle(FraigHandle handle) const;
+
 public:
   //////////////////////////////////////////////////////////////////////
   // 構造(FraigNode)を作成するメンバ関数
@@ -170,11 +211,58 @@ public:
   /// @param[in] edge 対象の AIG ハンドル
   /// @param[in] input_id コファクターをとる入力番号
   /// @param[in] inv 反転フラグ
+  ///
+  /// inv が false の時は入力を 1 に，true の時は 0 に固定する．
+  /// compose() の特別な場合なので計算量は edge のファンインコーンの大きさに比例する．
   FraigHandle
   make_cofactor(FraigHandle edge,
 		int input_id,
 		bool inv);
 
+  /// @brief 入力を他のハンドルで置き換えた関数を作る．
+  /// @param[in] edge 対象の AIG ハンドル
+  /// @param[in] comp_list (入力番号, 置き換えるハンドル)のリスト
+  ///
+  /// comp_list に含まれない入力はそのまま残る．
+  /// 置き換えは同時に行われる．
+  FraigHandle
+  compose(FraigHandle edge,
+	  const vector<pair<int, FraigHandle>>& comp_list);
+
+  /// @brief 複数のハンドルについて入力を他のハンドルで置き換えた関数を作る．
+  /// @param[in] edge_list 対象の AIG ハンドルのリスト
+  /// @param[in] comp_list (入力番号, 置き換えるハンドル)のリスト
+  /// @param[out] output_list 結果のハンドルのリスト
+  ///
+  /// edge_list の全てのファンインコーンをノード番号の順に1度だけたどり，
+  /// 各ノードの結果を共有する．
+  /// output_list[i] が edge_list[i] に対応する．
+  void
+  compose(const vector<FraigHandle>& edge_list,
+	  const vector<pair<int, FraigHandle>>& comp_list,
+	  vector<FraigHandle>& output_list);
+
+  /// @brief 入力を存在量化した関数を作る．
+  /// @param[in] edge 対象の AIG ハンドル
+  /// @param[in] input_list 量化する入力番号のリスト
+  ///
+  /// 依存するノード数が最も少ない入力から順に両方のコファクターの
+  /// OR をとって消去する．
+  /// 入力ごとのノード数の増加は set_loglevel() で 1 以上を指定すると
+  /// ログに出力され，その集計は dump_stats() で出力される．
+  FraigHandle
+  exists(FraigHandle edge,
+	 const vector<int>& input_list);
+
+  /// @brief 入力を全称量化した関数を作る．
+  /// @param[in] edge 対象の AIG ハンドル
+  /// @param[in] input_list 量化する入力番号のリスト
+  ///
+  /// exists() と同様だがコファクターの AND をとる．
+  FraigHandle
+  forall(FraigHandle edge,
+	 const vector<int>& input_list);
+
   /// @brief BnNetwork をインポートする．
   /// @param[in] network インポートするネットワーク
   /// @param[in] input_handles ネットワークの入力に接続するハンドルのリスト
@@ -184,6 +272,87 @@ public:
 		    const vector<FraigHandle>& input_handles,
 		    vector<FraigHandle>& output_handles);
 
+  /// @brief バイナリ AIGER 形式のファイルをインポートする．
+  /// @param[in] filename ファイル名
+  /// @param[inout] input_handles ファイルの入力に接続するハンドルのリスト
+  /// @param[out] output_handles ファイルの出力に対応したハンドルのリスト
+  /// @param[in] deferred true の時は読み込みの間 SAT を用いない．
+  /// @return 読み込みに成功したら true を返す．
+  ///
+  /// ファイルはメモリにマップし，AND ゲートを直接 make_and() で作る．
+  /// ラッチの出力は入力の後ろに，ラッチの入力は出力の後ろに並ぶ．
+  /// AIGER 1.9 の bad state はさらにその後ろに出力として並ぶ．
+  /// input_handles が空の時は入力を新たに作って input_handles に入れる．
+  /// deferred が true の時は読み込みの間だけ set_batch_mode(true) と
+  /// 同様に動作するので，等価候補の検査は次の sweep() で
+  /// ランダムパタンを加えてクラスを分割してからまとめて行われる．
+  bool
+  import_aig(const string& filename,
+	     vector<FraigHandle>& input_handles,
+	     vector<FraigHandle>& output_handles,
+	     bool deferred = false);
+
+  /// @brief 出力のファンインコーンをバイナリ AIGER 形式で書き出す．
+  /// @param[in] filename ファイル名
+  /// @param[in] output_handles 出力のハンドルのリスト
+  /// @return 書き出しに成功したら true を返す．
+  ///
+  /// 代表ノードのみからなる出力のファンインコーンを
+  /// 出力から深さ優先でたどった帰りがけ順(トポロジカル順)に書き出す．
+  /// 入力は使われていないものも含めて全て入力番号の順に並ぶので，
+  /// import_aig() で読み込めば同じ入力に接続できる．
+  bool
+  export_aig(const string& filename,
+	     const vector<FraigHandle>& output_handles) const;
+
+  /// @brief 出力のファンインコーンをバイナリ AIGER 形式で書き出す．
+  /// @param[in] s 出力先のストリーム
+  /// @param[in] output_handles 出力のハンドルのリスト
+  ///
+  /// s はバイナリモードで開かれていなければならない．
+  void
+  export_aig(ostream& s,
+	     const vector<FraigHandle>& output_handles) const;
+
+  /// @brief 出力のファンインコーンを BnNetwork に書き出す．
+  /// @param[in] output_handles 出力のハンドルのリスト
+  /// @param[out] network 結果のネットワーク
+  ///
+  /// export_aig() と同じノードを同じ順に作る．
+  /// 入力と出力はそれぞれ1ビットのポートになる．
+  /// 否定は必要になった時に1つだけ作り，
+  /// 両方のファンインが否定の AND は NOR にする．
+  void
+  export_network(const vector<FraigHandle>& output_handles,
+		 BnNetwork& network) const;
+
+  /// @brief 使われていないノードを削除する．
+  /// @param[in] handle_list 使用中のハンドルのリスト
+  ///
+  /// handle_list と外部入力から到達できないノードを削除して
+  /// ノード番号を詰める．ノードのメモリ，パタン，構造ハッシュの要素を回収し，
+  /// 削除された変数が多くなった場合は SAT ソルバも作り直す．
+  /// handle_list の内容は新しいハンドルに書き換えられる．
+  /// 外部入力のハンドルも変わるので input_handle() で取り直すこと．
+  /// これら以外のハンドルは無効になる．
+  void
+  garbage_collect(vector<FraigHandle>& handle_list);
+
+  /// @brief SAT スイープを行う．
+  /// @param[in] handle_list 使用中のハンドルのリスト
+  ///
+  /// 構築中の検査でアボートしたりバッチモードで調べなかったりして
+  /// 残っている等価候補と定数の候補を
+  /// ノード番号の順に set_sweep_limit() の予算で調べ，
+  /// 等価なノードをマージしてファンアウトをつなぎ替える．
+  /// 検査は set_thread_num() のスレッド数で並列に行い，
+  /// スレッドごとに別の SAT ソルバを用いる．
+  /// 結果は検査の順番に反映するのでスレッド数が同じなら結果は決定的
+  /// 最後に garbage_collect(handle_list) を行うので
+  /// ハンドルの扱いは garbage_collect() と同じ
+  void
+  sweep(vector<FraigHandle>& handle_list);
+
 
 public:
   //////////////////////////////////////////////////////////////////////
@@ -208,10 +377,133 @@ public:
   void
   set_loop_limit(int loop_limit);
 
+  /// @brief シミュレーションと sweep() に用いるスレッド数を設定する．
+  /// @param[in] num スレッド数
+  ///
+  /// シミュレーションの結果はスレッド数によらず同じになる．
+  /// デフォルトは 1 (並列化しない)
+  void
+  set_thread_num(int num);
+
+  /// @brief check_const で用いる SAT の予算を設定する．
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// どれも 0 の場合は制限なしを表す．
+  /// 予算を使い切った検査はアボート(SatBool3::X)となる．
+  void
+  set_check_const_limit(SizeType conflict_limit,
+			SizeType propagation_limit = 0,
+			int time_limit = 0);
+
+  /// @brief check_equiv で用いる SAT の予算を設定する．
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// どれも 0 の場合は制限なしを表す．
+  /// 予算を使い切った検査はアボート(SatBool3::X)となる．
+  void
+  set_check_equiv_limit(SizeType conflict_limit,
+			SizeType propagation_limit = 0,
+			int time_limit = 0);
+
+  /// @brief sweep() で用いる SAT の予算を設定する．
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// どれも 0 の場合は制限なしを表す．
+  /// 1回の sweep() の中でアボートした検査は再び行わない．
+  void
+  set_sweep_limit(SizeType conflict_limit,
+		  SizeType propagation_limit = 0,
+		  int time_limit = 0);
+
+  /// @brief 一度アボートした検査を再び行わないかどうかを設定する．
+  /// @param[in] flag true の時は同じ検査を行わずにアボートとして扱う．
+  ///
+  /// デフォルトは true
+  void
+  set_skip_aborted(bool flag);
+
+  /// @brief 等価検査をミタ回路を用いた1回の SAT で行うかどうかを設定する．
+  /// @param[in] flag true の時は活性化リテラルつきのミタ回路を用いる．
+  ///
+  /// false の時は2つの含意をそれぞれ SAT で調べる．
+  /// デフォルトは false
+  void
+  set_miter_check(bool flag);
+
+  /// @brief 構築中の検査を sweep() にまとめるかどうかを設定する．
+  /// @param[in] flag true の時は make_and() で SAT を用いない．
+  /// @param[in] sim_words sweep() の最初に加えるランダムパタンのワード数
+  ///
+  /// true の時の make_and() は構造ハッシュとシミュレーションのみを行い，
+  /// 新しいノードを等価候補のクラスに加える．
+  /// 縮退や等価の検査は sweep() を呼んだ時に，
+  /// sim_words ワードのランダムパタンでクラスを分割してから
+  /// ノード番号の順にまとめて行う．
+  /// sweep() を呼ぶまでは等価なノードがマージされずに残る．
+  /// sweep() の前にバッチモードを解除してもランダムパタンは加えられる．
+  /// デフォルトは false
+  void
+  set_batch_mode(bool flag,
+		 int sim_words = 32);
+
+  /// @brief SAT ソルバを作り直す条件を設定する．
+  /// @param[in] clause_limit 節数の上限
+  /// @param[in] var_limit 変数の数の上限
+  /// @param[in] time_ratio 平均検査時間の悪化率の上限
+  ///
+  /// 長く使ったソルバには学習節やマージ済みのノードの節が溜まるので，
+  /// どれかの条件を超えたら代表ノードのみからソルバを作り直す．
+  /// time_ratio は作り直した直後の平均検査時間に対する比率
+  /// どれも 0 の場合は用いない．デフォルトはどれも 0
+  void
+  set_rebuild_limit(SizeType clause_limit,
+		    SizeType var_limit = 0,
+		    double time_ratio = 0.0);
+
+  /// @brief ポートフォリオに用いる SAT ソルバを設定する．
+  /// @param[in] type_list SAT ソルバの種類のリスト
+  /// @param[in] conflict_limit コンフリクト数の上限
+  /// @param[in] propagation_limit 含意操作の回数の上限
+  /// @param[in] time_limit 時間の上限(秒)
+  ///
+  /// set_check_const_limit() や set_check_equiv_limit() の予算で
+  /// アボートした検査を type_list の各ソルバに別々のスレッドで解かせ，
+  /// 最初に答えを出したものを採用して残りは中止させる．
+  /// 上限は各ソルバの1回の SAT ごとに適用される．0 は制限なしを表す．
+  /// ソルバごとの勝った回数は dump_stats() で出力される．
+  /// type_list が空の場合は用いない．デフォルトは空
+  void
+  set_portfolio(const vector<SatSolverType>& type_list,
+		SizeType conflict_limit = 0,
+		SizeType propagation_limit = 0,
+		int time_limit = 0);
+
+  /// @brief SAT ソルバに CNF の前処理を行わせる．
+  ///
+  /// マージされたノードの変数は凍結されていないので
+  /// SAT ソルバの変数除去によって取り除かれる．
+  /// 多数の検査を行う前に呼ぶと以降の SAT が速くなる場合がある．
+  void
+  preprocess_cnf();
+
   /// @brief 内部の統計情報を出力する．
   void
   dump_stats(ostream& s);
 
+  /// @brief ポートフォリオのソルバを競争させた回数を返す．
+  int
+  race_count() const;
+
+  /// @brief ランダムシミュレーションで加えたパタンのワード数を返す．
+  int
+  sim_count() const;
+
 
 private:
   //////////////////////////////////////////////////////////////////////
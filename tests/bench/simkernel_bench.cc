@@ -0,0 +1,98 @@
+
+/// @file simkernel_bench.cc
+/// @brief SimKernel のマイクロベンチマーク
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "SimKernel.h"
+#include <chrono>
+#include <random>
+
+
+BEGIN_NAMESPACE_FRAIG
+
+BEGIN_NONAMESPACE
+
+// 経過時間を秒で返す．
+template<typename F>
+double
+measure(F func)
+{
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+END_NONAMESPACE
+
+int
+simkernel_bench(int argc,
+		const char** argv)
+{
+  int nw = 1024;
+  int loop = 100000;
+  if ( argc > 1 ) {
+    nw = atoi(argv[1]);
+  }
+  if ( argc > 2 ) {
+    loop = atoi(argv[2]);
+  }
+
+  std::mt19937_64 rg;
+  vector<ymuint64> src1(nw);
+  vector<ymuint64> src2(nw);
+  vector<ymuint64> dst(nw);
+  for ( int i = 0; i < nw; ++ i ) {
+    src1[i] = rg();
+    src2[i] = ~src1[i];
+  }
+
+  double total = static_cast<double>(nw) * loop;
+  cout << "words = " << nw << ", loop = " << loop << endl;
+  for ( auto type: { SimKernel::kGeneric, SimKernel::kAvx2, SimKernel::kAvx512 } ) {
+    if ( !SimKernel::set_type(type) ) {
+      cout << setw(8) << SimKernel::type_name(type)
+	   << ": not supported" << endl;
+      continue;
+    }
+
+    double t1 = measure([&]() {
+	for ( int l = 0; l < loop; ++ l ) {
+	  SimKernel::and_pat(dst.data(), src1.data(), src2.data(), nw,
+			     l & 1, l & 2);
+	}
+      });
+
+    // 反転して等しいパタンなので常に最後まで比較される．
+    int count = 0;
+    double t2 = measure([&]() {
+	for ( int l = 0; l < loop; ++ l ) {
+	  if ( SimKernel::equal_pat(src1.data(), src2.data(), nw, true) ) {
+	    ++ count;
+	  }
+	}
+      });
+    ASSERT_COND( count == loop );
+
+    cout << setw(8) << SimKernel::type_name(type)
+	 << ": and_pat " << total / t1 * 1.0e-6 << " Mwords/sec"
+	 << ", equal_pat " << total / t2 * 1.0e-6 << " Mwords/sec"
+	 << endl;
+  }
+
+  return 0;
+}
+
+END_NAMESPACE_FRAIG
+
+
+int
+main(int argc,
+     const char** argv)
+{
+  return YM_NAMESPACE::nsFraig::simkernel_bench(argc, argv);
+}
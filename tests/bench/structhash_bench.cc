@@ -0,0 +1,243 @@
+
+/// @file structhash_bench.cc
+/// @brief StructHash のマイクロベンチマーク
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "StructHash.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+
+BEGIN_NAMESPACE_FRAIG
+
+BEGIN_NONAMESPACE
+
+// 経過時間を秒で返す．
+template<typename F>
+double
+measure(F func)
+{
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// 比較用のチェイン法による構造ハッシュ表
+// (オープンアドレス法にする前の StructHash と同じもの)
+class ChainHash
+{
+public:
+
+  ChainHash()
+  {
+    alloc_table(1024);
+  }
+
+  int
+  find(ymuint32 lit0,
+       ymuint32 lit1) const
+  {
+    SizeType pos = hash_func(lit0, lit1) & (mTable.size() - 1);
+    for ( int c = mTable[pos]; c != -1; c = mCellArray[c].mLink ) {
+      const Cell& cell = mCellArray[c];
+      if ( cell.mLit0 == lit0 && cell.mLit1 == lit1 ) {
+	return cell.mId;
+      }
+    }
+    return -1;
+  }
+
+  void
+  add(ymuint32 lit0,
+      ymuint32 lit1,
+      int id)
+  {
+    if ( mCellArray.size() >= mNextLimit ) {
+      alloc_table(mTable.size() * 2);
+      int n = mCellArray.size();
+      for ( int c = 0; c < n; ++ c ) {
+	Cell& cell = mCellArray[c];
+	SizeType pos = hash_func(cell.mLit0, cell.mLit1) & (mTable.size() - 1);
+	cell.mLink = mTable[pos];
+	mTable[pos] = c;
+      }
+    }
+    SizeType pos = hash_func(lit0, lit1) & (mTable.size() - 1);
+    int c = mCellArray.size();
+    mCellArray.push_back(Cell{lit0, lit1, id, mTable[pos]});
+    mTable[pos] = c;
+  }
+
+private:
+
+  struct Cell
+  {
+    ymuint32 mLit0;
+    ymuint32 mLit1;
+    int mId;
+    int mLink;
+  };
+
+  void
+  alloc_table(int req_size)
+  {
+    int size = 1024;
+    while ( size < req_size ) {
+      size <<= 1;
+    }
+    mTable.clear();
+    mTable.resize(size, -1);
+    mNextLimit = static_cast<int>(size * 1.8);
+  }
+
+  static
+  SizeType
+  hash_func(ymuint32 lit0,
+	    ymuint32 lit1)
+  {
+    return lit0 + lit1 * 7;
+  }
+
+  vector<Cell> mCellArray;
+  vector<int> mTable;
+  int mNextLimit;
+};
+
+// AIG の構築と同じように「探して無ければ登録」を繰り返した後，
+// 登録済みのキー(ヒット)と未登録のキー(ミス)を order の順に引く．
+template<typename Hash>
+void
+run_bench(const char* name,
+	  const vector<ymuint32>& key_list,
+	  const vector<int>& order,
+	  int loop)
+{
+  int n = key_list.size() / 2;
+  int count = 0;
+  double t1 = measure([&]() {
+      Hash hash;
+      for ( int i = 0; i < n; ++ i ) {
+	ymuint32 lit0 = key_list[i * 2 + 0];
+	ymuint32 lit1 = key_list[i * 2 + 1];
+	if ( hash.find(lit0, lit1) == -1 ) {
+	  hash.add(lit0, lit1, i);
+	  ++ count;
+	}
+      }
+    });
+
+  Hash hash;
+  for ( int i = 0; i < n; ++ i ) {
+    ymuint32 lit0 = key_list[i * 2 + 0];
+    ymuint32 lit1 = key_list[i * 2 + 1];
+    if ( hash.find(lit0, lit1) == -1 ) {
+      hash.add(lit0, lit1, i);
+    }
+  }
+
+  int hit = 0;
+  double t2 = measure([&]() {
+      for ( int l = 0; l < loop; ++ l ) {
+	for ( int i: order ) {
+	  // ヒットとミスを半分ずつ引く．
+	  ymuint32 lit0 = key_list[i * 2 + 0];
+	  ymuint32 lit1 = key_list[i * 2 + 1] ^ (i & 1 ? 0x80000000U : 0U);
+	  if ( hash.find(lit0, lit1) != -1 ) {
+	    ++ hit;
+	  }
+	}
+      }
+    });
+
+  // make_and() のように1回ずつ結果を使う場合を模して
+  // 前の結果に依存させ，メモリアクセスが重ならないようにする．
+  // (ans は -1 以上なので j は常に i に等しい)
+  int ans = 0;
+  int hit2 = 0;
+  double t3 = measure([&]() {
+      for ( int l = 0; l < loop; ++ l ) {
+	for ( int i: order ) {
+	  int j = i + (ans < -1 ? 1 : 0);
+	  ymuint32 lit0 = key_list[j * 2 + 0];
+	  ymuint32 lit1 = key_list[j * 2 + 1] ^ (j & 1 ? 0x80000000U : 0U);
+	  ans = hash.find(lit0, lit1);
+	  if ( ans != -1 ) {
+	    ++ hit2;
+	  }
+	}
+      }
+    });
+  ASSERT_COND( hit2 == hit );
+
+  double total = static_cast<double>(n) * loop;
+  cout << setw(6) << name
+       << ": build " << n / t1 * 1.0e-6 << " Mops/sec"
+       << " (" << count << " nodes)"
+       << ", find " << total / t2 * 1.0e-6 << " Mops/sec"
+       << " (" << hit << " hits)"
+       << ", dependent find " << t3 / total * 1.0e9 << " ns/op"
+       << endl;
+}
+
+END_NONAMESPACE
+
+int
+structhash_bench(int argc,
+		 const char** argv)
+{
+  int nn = 1000000;
+  int loop = 10;
+  if ( argc > 1 ) {
+    nn = atoi(argv[1]);
+  }
+  if ( argc > 2 ) {
+    loop = atoi(argv[2]);
+  }
+
+  // AIG らしいキーを作る．
+  // ファンインは自分より前のノードで，番号の大きいものを lit0 にする．
+  std::mt19937 rg;
+  int ni = 1000;
+  vector<ymuint32> key_list(nn * 2);
+  for ( int i = 0; i < nn; ++ i ) {
+    int id = ni + i + 1;
+    std::uniform_int_distribution<int> rd(1, id - 1);
+    ymuint32 lit0 = rd(rg) * 2 + (rg() & 1);
+    ymuint32 lit1 = rd(rg) * 2 + (rg() & 1);
+    if ( lit0 < lit1 ) {
+      std::swap(lit0, lit1);
+    }
+    key_list[i * 2 + 0] = lit0;
+    key_list[i * 2 + 1] = lit1;
+  }
+
+  // 登録順に引くとチェイン法のセルの配列が順にアクセスされて
+  // 有利になりすぎるので，引く順番はシャッフルしておく．
+  vector<int> order(nn);
+  for ( int i = 0; i < nn; ++ i ) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), rg);
+
+  cout << "nodes = " << nn << ", loop = " << loop << endl;
+  run_bench<ChainHash>("chain", key_list, order, loop);
+  run_bench<StructHash>("open", key_list, order, loop);
+
+  return 0;
+}
+
+END_NAMESPACE_FRAIG
+
+
+int
+main(int argc,
+     const char** argv)
+{
+  return YM_NAMESPACE::nsFraig::structhash_bench(argc, argv);
+}
@@ -0,0 +1,171 @@
+
+/// @file sweep_bench.cc
+/// @brief FraigMgr::sweep() のスレッド数による速度向上を測るベンチマーク
+/// @author Yusuke Matsunaga (松永 裕介)
+///
+/// Copyright (C) 2018 Yusuke Matsunaga
+/// All rights reserved.
+
+
+#include "ym/FraigMgr.h"
+#include "ym/BnNetwork.h"
+#include "ym/Range.h"
+#include <chrono>
+#include <functional>
+#include <random>
+
+
+BEGIN_NAMESPACE_FRAIG
+
+BEGIN_NONAMESPACE
+
+// 経過時間を秒で返す．
+template<typename F>
+double
+measure(F func)
+{
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// 回路を作る関数
+using BuildFunc = std::function<void(FraigMgr&, vector<FraigHandle>&)>;
+
+// 回路を作って sweep() の時間を測る．
+// 構築中の検査は予算を最小にしてほとんどアボートさせ，
+// 等価候補を sweep() に残しておく．
+double
+sweep_time(const BuildFunc& build,
+	   int thread_num)
+{
+  FraigMgr mgr(16);
+  mgr.set_thread_num(thread_num);
+  mgr.set_check_const_limit(1);
+  mgr.set_check_equiv_limit(1);
+
+  vector<FraigHandle> root_list;
+  build(mgr, root_list);
+  return measure([&]() { mgr.sweep(root_list); });
+}
+
+// スレッド数を変えて sweep() の時間を測る．
+void
+speedup_curve(const string& name,
+	      const BuildFunc& build,
+	      int max_thread)
+{
+  cout << name << endl;
+  double t1 = 0.0;
+  for ( int nt = 1; nt <= max_thread; nt *= 2 ) {
+    double t = sweep_time(build, nt);
+    if ( nt == 1 ) {
+      t1 = t;
+    }
+    cout << "  threads = " << setw(3) << nt
+	 << ": " << t << " sec., speedup = " << t1 / t << endl;
+  }
+}
+
+// 2つの BLIF ファイルの出力を同じ入力で作る．
+BuildFunc
+blif_pair(const string& path1,
+	  const string& path2)
+{
+  return [=](FraigMgr& mgr, vector<FraigHandle>& root_list) {
+    BnNetwork network1 = BnNetwork::read_blif(path1);
+    BnNetwork network2 = BnNetwork::read_blif(path2);
+    int ni = network1.input_num();
+    int no = network1.output_num();
+    vector<FraigHandle> input_handles(ni);
+    for ( int i: Range(ni) ) {
+      input_handles[i] = mgr.make_input();
+    }
+    vector<FraigHandle> output_handles1(no);
+    mgr.import_subnetwork(network1, input_handles, output_handles1);
+    vector<FraigHandle> output_handles2(no);
+    mgr.import_subnetwork(network2, input_handles, output_handles2);
+    root_list = output_handles1;
+    root_list.insert(root_list.end(),
+		     output_handles2.begin(), output_handles2.end());
+  };
+}
+
+// 構造の異なる等価な2つのランダム回路を作る．
+// 各ゲートは3入力 AND か XOR で，一方は左から，もう一方は右から組み立てる．
+BuildFunc
+synthetic_miter(int ni,
+		int ng)
+{
+  return [=](FraigMgr& mgr, vector<FraigHandle>& root_list) {
+    std::mt19937 rg(ni * 65537 + ng);
+    vector<FraigHandle> list1;
+    for ( int i = 0; i < ni; ++ i ) {
+      list1.push_back(mgr.make_input());
+    }
+    vector<FraigHandle> list2 = list1;
+    for ( int g = 0; g < ng; ++ g ) {
+      int n = list1.size();
+      int a = rg() % n;
+      int b = rg() % n;
+      int c = rg() % n;
+      bool inv = rg() & 1;
+      FraigHandle h1;
+      FraigHandle h2;
+      if ( rg() % 4 == 0 ) {
+	h1 = mgr.make_xor(mgr.make_xor(list1[a], list1[b]), list1[c]);
+	h2 = mgr.make_xor(list2[a], mgr.make_xor(list2[b], list2[c]));
+      }
+      else {
+	h1 = mgr.make_and(mgr.make_and(list1[a], ~list1[b]), list1[c]);
+	h2 = mgr.make_and(list2[a], mgr.make_and(~list2[b], list2[c]));
+      }
+      list1.push_back(inv ? ~h1 : h1);
+      list2.push_back(inv ? ~h2 : h2);
+    }
+    for ( int i = ni; i < ni + ng; i += 8 ) {
+      root_list.push_back(list1[i]);
+      root_list.push_back(list2[i]);
+    }
+  };
+}
+
+END_NONAMESPACE
+
+int
+sweep_bench(int argc,
+	    const char** argv)
+{
+  int max_thread = 8;
+  int ng = 20000;
+  if ( argc > 1 ) {
+    max_thread = atoi(argv[1]);
+  }
+  if ( argc > 2 ) {
+    ng = atoi(argv[2]);
+  }
+
+  speedup_curve("C499/C1355",
+		blif_pair(string(DATAPATH) + "C499.blif",
+			  string(DATAPATH) + "C1355.blif"),
+		max_thread);
+  speedup_curve("synthetic miter (" + std::to_string(ng) + " gates)",
+		synthetic_miter(64, ng),
+		max_thread);
+  speedup_curve("synthetic miter (" + std::to_string(ng * 4) + " gates)",
+		synthetic_miter(128, ng * 4),
+		max_thread);
+
+  return 0;
+}
+
+END_NAMESPACE_FRAIG
+
+
+int
+main(int argc,
+     const char** argv)
+{
+  return YM_NAMESPACE::nsFraig::sweep_bench(argc, argv);
+}
@@ -11,6 +11,8 @@
 #include "ym/FraigMgr.h"
 #include "ym/BnNetwork.h"
 #include "ym/Range.h"
+#include <fstream>
+#include <sstream>
 
 
 BEGIN_NAMESPACE_FRAIG
@@ -51,4 +53,379 @@ TEST(EquivTest, EquivTest1)
   }
 }
 
+TEST(EquivTest, EquivTest_mt)
+{
+  string filename1 = "C499.blif";
+  string path1 = DATAPATH + filename1;
+  BnNetwork network1 = BnNetwork::read_blif(path1);
+  ASSERT_TRUE( network1.node_num() != 0 );
+
+  int ni = network1.input_num();
+  int no = network1.output_num();
+
+  string filename2 = "C1355.blif";
+  string path2 = DATAPATH + filename2;
+  BnNetwork network2 = BnNetwork::read_blif(path2);
+  ASSERT_TRUE( network2.node_num() != 0 );
+
+  FraigMgr mgr(1000);
+  mgr.set_thread_num(4);
+
+  vector<FraigHandle> input_handles(ni);
+  for ( int i: Range(ni) ) {
+    input_handles[i] = mgr.make_input();
+  }
+
+  vector<FraigHandle> output_handles1(no);
+  mgr.import_subnetwork(network1, input_handles, output_handles1);
+
+  vector<FraigHandle> output_handles2(no);
+  mgr.import_subnetwork(network2, input_handles, output_handles2);
+
+  for ( int i: Range(no) ) {
+    SatBool3 stat = mgr.check_equiv(output_handles1[i], output_handles2[i]);
+    EXPECT_EQ( SatBool3::True, stat );
+  }
+}
+
+TEST(EquivTest, EquivTest_gc)
+{
+  string filename1 = "C499.blif";
+  string path1 = DATAPATH + filename1;
+  BnNetwork network1 = BnNetwork::read_blif(path1);
+  ASSERT_TRUE( network1.node_num() != 0 );
+
+  int ni = network1.input_num();
+  int no = network1.output_num();
+
+  string filename2 = "C1355.blif";
+  string path2 = DATAPATH + filename2;
+  BnNetwork network2 = BnNetwork::read_blif(path2);
+  ASSERT_TRUE( network2.node_num() != 0 );
+  ASSERT_TRUE( network2.input_num() == ni );
+  ASSERT_TRUE( network2.output_num() == no );
+
+  FraigMgr mgr(1000);
+
+  vector<FraigHandle> input_handles(ni);
+  for ( int i: Range(ni) ) {
+    input_handles[i] = mgr.make_input();
+  }
+
+  // 一度 network2 を読み込んで捨てる．
+  vector<FraigHandle> output_handles1(no);
+  mgr.import_subnetwork(network1, input_handles, output_handles1);
+  vector<FraigHandle> output_handles2(no);
+  mgr.import_subnetwork(network2, input_handles, output_handles2);
+  mgr.garbage_collect(output_handles1);
+
+  for ( int i: Range(ni) ) {
+    input_handles[i] = mgr.input_handle(i);
+  }
+  mgr.import_subnetwork(network2, input_handles, output_handles2);
+
+  for ( int i: Range(no) ) {
+    SatBool3 stat = mgr.check_equiv(output_handles1[i], output_handles2[i]);
+    EXPECT_EQ( SatBool3::True, stat );
+  }
+}
+
+TEST(EquivTest, EquivTest_batch)
+{
+  string filename1 = "C499.blif";
+  string path1 = DATAPATH + filename1;
+  BnNetwork network1 = BnNetwork::read_blif(path1);
+  ASSERT_TRUE( network1.node_num() != 0 );
+
+  int ni = network1.input_num();
+  int no = network1.output_num();
+
+  string filename2 = "C1355.blif";
+  string path2 = DATAPATH + filename2;
+  BnNetwork network2 = BnNetwork::read_blif(path2);
+  ASSERT_TRUE( network2.node_num() != 0 );
+  ASSERT_TRUE( network2.input_num() == ni );
+  ASSERT_TRUE( network2.output_num() == no );
+
+  FraigMgr mgr(16);
+  mgr.set_batch_mode(true);
+  mgr.set_thread_num(2);
+
+  vector<FraigHandle> input_handles(ni);
+  for ( int i: Range(ni) ) {
+    input_handles[i] = mgr.make_input();
+  }
+
+  vector<FraigHandle> output_handles1(no);
+  mgr.import_subnetwork(network1, input_handles, output_handles1);
+  vector<FraigHandle> output_handles2(no);
+  mgr.import_subnetwork(network2, input_handles, output_handles2);
+
+  // 構築中は検査を行わないので sweep() で等価な出力がまとめられる．
+  vector<FraigHandle> handle_list(output_handles1);
+  handle_list.insert(handle_list.end(),
+		     output_handles2.begin(), output_handles2.end());
+  mgr.sweep(handle_list);
+
+  for ( int i: Range(no) ) {
+    EXPECT_EQ( handle_list[i], handle_list[i + no] );
+  }
+}
+
+TEST(EquivTest, EquivTest_portfolio)
+{
+  // 鳩の巣原理の式は真理値表で調べられないサポートを持ち，
+  // 充足不能の証明には多くのコンフリクトを要する．
+  // 主のソルバの予算を最小にしてポートフォリオに解かせる．
+  FraigMgr mgr(16);
+  mgr.set_check_const_limit(1);
+  mgr.set_check_equiv_limit(1);
+  mgr.set_portfolio({SatSolverType(), SatSolverType()});
+
+  // np 羽の鳩をそれぞれ nh 個の巣のどれかに1羽ずつ入れる条件
+  auto php = [&](int np, int nh) {
+    vector<vector<FraigHandle>> x(np, vector<FraigHandle>(nh));
+    for ( int p: Range(np) ) {
+      for ( int h: Range(nh) ) {
+	x[p][h] = mgr.make_input();
+      }
+    }
+    vector<FraigHandle> cube;
+    for ( int p: Range(np) ) {
+      cube.push_back(mgr.make_or(x[p]));
+    }
+    for ( int h: Range(nh) ) {
+      for ( int p: Range(np) ) {
+	for ( int q = p + 1; q < np; ++ q ) {
+	  cube.push_back(mgr.make_nand(x[p][h], x[q][h]));
+	}
+      }
+    }
+    return mgr.make_and(cube);
+  };
+
+  // 前の競争で負けて止められたソルバも次の競争で使われる．
+  int count0 = mgr.race_count();
+  FraigHandle f1 = php(6, 5);
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(f1, mgr.make_zero()) );
+  int count1 = mgr.race_count();
+  EXPECT_LT( count0, count1 );
+
+  FraigHandle f2 = php(5, 4);
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(f2, mgr.make_zero()) );
+  EXPECT_LT( count1, mgr.race_count() );
+
+  // 充足可能な場合
+  FraigHandle f3 = php(5, 5);
+  EXPECT_EQ( SatBool3::False, mgr.check_equiv(f3, mgr.make_zero()) );
+}
+
+TEST(HandleTest, literal)
+{
+  EXPECT_EQ( 4, sizeof(FraigHandle) );
+  EXPECT_EQ( 0, FraigHandle::zero().lit() );
+  EXPECT_EQ( 1, FraigHandle::one().lit() );
+
+  FraigMgr mgr(10);
+
+  // ノード番号 0 は定数用なので入力は 1 から順に番号が振られる．
+  FraigHandle h1 = mgr.make_input();
+  FraigHandle h2 = mgr.make_input();
+  EXPECT_EQ( 2, h1.lit() );
+  EXPECT_EQ( 4, h2.lit() );
+  EXPECT_TRUE( mgr.is_input(h1) );
+  EXPECT_EQ( 1, mgr.input_id(h2) );
+
+  FraigHandle h3 = mgr.make_and(h1, ~h2);
+  EXPECT_TRUE( mgr.is_and(h3) );
+  EXPECT_EQ( FraigHandle::from_lit(h3.lit()), h3 );
+  EXPECT_EQ( h3, mgr.make_and(~h2, h1) );
+  EXPECT_EQ( FraigHandle::zero(), mgr.make_and(h3, ~h1) );
+}
+
+TEST(CofactorTest, reconvergent)
+{
+  FraigMgr mgr(16);
+
+  const int n = 64;
+  vector<FraigHandle> x(n);
+  for ( int i: Range(n) ) {
+    x[i] = mgr.make_input();
+  }
+
+  // 各段が前段を2回参照するので木としてたどると 2^n になる．
+  auto build = [&](FraigHandle z) {
+    for ( int i = 1; i < n; ++ i ) {
+      z = mgr.make_or(mgr.make_and(z, x[i]), mgr.make_and(~z, ~x[i]));
+    }
+    return z;
+  };
+  FraigHandle f = build(x[0]);
+
+  FraigHandle f1 = mgr.make_cofactor(f, 0, false);
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(f1, build(mgr.make_one())) );
+  FraigHandle f0 = mgr.make_cofactor(f, 0, true);
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(f0, build(mgr.make_zero())) );
+
+  FraigHandle g = mgr.compose(f, {{0, x[1]}});
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(g, build(x[1])) );
+
+  vector<FraigHandle> output_list;
+  mgr.compose({f, ~f}, {{0, ~x[0]}}, output_list);
+  ASSERT_EQ( 2, output_list.size() );
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(output_list[0], ~f) );
+  EXPECT_EQ( ~output_list[0], output_list[1] );
+}
+
+TEST(QuantifyTest, mux)
+{
+  FraigMgr mgr(16);
+
+  const int n = 8;
+  vector<FraigHandle> x(n);
+  for ( int i: Range(n) ) {
+    x[i] = mgr.make_input();
+  }
+
+  // x[0] が選択信号のマルチプレクサを段につなぐ．
+  FraigHandle f = x[1];
+  for ( int i = 2; i < n; ++ i ) {
+    f = mgr.make_or(mgr.make_and(x[0], f), mgr.make_and(~x[0], x[i]));
+  }
+  FraigHandle g1 = x[1];
+  FraigHandle g0 = x[n - 1];
+
+  FraigHandle e = mgr.exists(f, {0});
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(e, mgr.make_or(g0, g1)) );
+  FraigHandle a = mgr.forall(f, {0});
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(a, mgr.make_and(g0, g1)) );
+
+  // 依存しない入力や重複した入力は無視される．
+  FraigHandle e2 = mgr.exists(f, {0, 3, 0});
+  EXPECT_EQ( SatBool3::True, mgr.check_equiv(e2, e) );
+
+  EXPECT_EQ( mgr.make_one(), mgr.exists(f, {0, 1, n - 1}) );
+  EXPECT_EQ( mgr.make_zero(), mgr.forall(f, {0, 1, n - 1}) );
+}
+
+TEST(AigTest, half_adder)
+{
+  // 半加算器の和をラッチの入力にもつないだもの
+  // 入力 2, 4 とラッチ 6 (入力は 12 = s)
+  // 8 = 4 & 2, 10 = 5 & 3, 12 = 11 & 9 = 2 xor 4
+  const char data[] =
+    "aig 6 2 1 2 3\n"
+    "12 0\n"
+    "12\n"
+    "8\n"
+    "\x04\x02"
+    "\x05\x02"
+    "\x01\x02"
+    "c\nhalf adder\n";
+  string filename = ::testing::TempDir() + "half_adder.aig";
+  {
+    std::ofstream ofs(filename, std::ios::binary);
+    ofs.write(data, sizeof(data) - 1);
+  }
+
+  for ( bool deferred: { false, true } ) {
+    FraigMgr mgr(16);
+    vector<FraigHandle> input_handles;
+    vector<FraigHandle> output_handles;
+    ASSERT_TRUE( mgr.import_aig(filename, input_handles, output_handles, deferred) );
+    ASSERT_EQ( 3, input_handles.size() );
+    ASSERT_EQ( 3, output_handles.size() );
+
+    if ( deferred ) {
+      // 読み込み中に作られたノードは次の sweep() で
+      // ランダムパタンを加えてから調べられる．
+      int count = mgr.sim_count();
+      mgr.sweep(output_handles);
+      EXPECT_LT( count, mgr.sim_count() );
+    }
+
+    FraigHandle x = input_handles[0];
+    FraigHandle y = input_handles[1];
+    FraigHandle s = mgr.make_xor(x, y);
+    FraigHandle c = mgr.make_and(x, y);
+    EXPECT_EQ( SatBool3::True, mgr.check_equiv(output_handles[0], s) );
+    EXPECT_EQ( SatBool3::True, mgr.check_equiv(output_handles[1], c) );
+    // ラッチの入力は出力の後ろに並ぶ．
+    EXPECT_EQ( SatBool3::True, mgr.check_equiv(output_handles[2], s) );
+
+    // 入力を与えた時はそれに接続する．
+    vector<FraigHandle> input_handles2{y, x, mgr.make_input()};
+    vector<FraigHandle> output_handles2;
+    ASSERT_TRUE( mgr.import_aig(filename, input_handles2, output_handles2) );
+    EXPECT_EQ( SatBool3::True, mgr.check_equiv(output_handles2[0], s) );
+  }
+
+  // 途中で切れたファイルは読み込まない．
+  {
+    std::ofstream ofs(filename, std::ios::binary);
+    ofs.write(data, 20);
+  }
+  FraigMgr mgr(16);
+  vector<FraigHandle> input_handles;
+  vector<FraigHandle> output_handles;
+  EXPECT_FALSE( mgr.import_aig(filename, input_handles, output_handles) );
+}
+
+TEST(AigTest, export)
+{
+  string filename1 = "C499.blif";
+  string path1 = DATAPATH + filename1;
+  BnNetwork network1 = BnNetwork::read_blif(path1);
+  ASSERT_TRUE( network1.node_num() != 0 );
+
+  int ni = network1.input_num();
+  int no = network1.output_num();
+
+  string filename2 = "C1355.blif";
+  string path2 = DATAPATH + filename2;
+  BnNetwork network2 = BnNetwork::read_blif(path2);
+  ASSERT_TRUE( network2.node_num() != 0 );
+  ASSERT_TRUE( network2.input_num() == ni );
+  ASSERT_TRUE( network2.output_num() == no );
+
+  FraigMgr mgr(1000);
+
+  vector<FraigHandle> input_handles(ni);
+  for ( int i: Range(ni) ) {
+    input_handles[i] = mgr.make_input();
+  }
+
+  vector<FraigHandle> output_handles1(no);
+  mgr.import_subnetwork(network1, input_handles, output_handles1);
+  vector<FraigHandle> output_handles2(no);
+  mgr.import_subnetwork(network2, input_handles, output_handles2);
+
+  // 代表ノードのみを書き出すので等価な回路は同じ内容になる．
+  std::ostringstream s1;
+  mgr.export_aig(s1, output_handles1);
+  std::ostringstream s2;
+  mgr.export_aig(s2, output_handles2);
+  EXPECT_EQ( s1.str(), s2.str() );
+
+  // 書き出したものを読み込むと元の出力と等価になる．
+  string filename = ::testing::TempDir() + "C499.aig";
+  ASSERT_TRUE( mgr.export_aig(filename, output_handles1) );
+  vector<FraigHandle> output_handles3;
+  ASSERT_TRUE( mgr.import_aig(filename, input_handles, output_handles3) );
+  ASSERT_EQ( no, output_handles3.size() );
+  for ( int i: Range(no) ) {
+    EXPECT_EQ( SatBool3::True, mgr.check_equiv(output_handles1[i], output_handles3[i]) );
+  }
+
+  BnNetwork network3;
+  mgr.export_network(output_handles1, network3);
+  ASSERT_EQ( ni, network3.input_num() );
+  ASSERT_EQ( no, network3.output_num() );
+  vector<FraigHandle> output_handles4(no);
+  mgr.import_subnetwork(network3, input_handles, output_handles4);
+  for ( int i: Range(no) ) {
+    EXPECT_EQ( SatBool3::True, mgr.check_equiv(output_handles1[i], output_handles4[i]) );
+  }
+}
+
 END_NAMESPACE_FRAIG